@@ -0,0 +1,27 @@
+# Writes every .glsl file in SHADER_DIR into OUTPUT as a table of C++ string literals, see
+# include/embedded_shaders.hpp. Run with cmake -DSHADER_DIR=... -DOUTPUT=... -P embed_shaders.cmake
+
+file(GLOB shaders "${SHADER_DIR}/*.glsl")
+list(SORT shaders)
+
+set(content "// Generated by cmake/embed_shaders.cmake from ${SHADER_DIR}, do not edit\n")
+string(APPEND content "#include <embedded_shaders.hpp>\n\n")
+string(APPEND content "const EmbeddedShader embedded_shaders[] = {\n")
+
+foreach(shader ${shaders})
+    get_filename_component(name "${shader}" NAME)
+    file(READ "${shader}" source)
+    string(APPEND content "    {\"${name}\", R\"glsl(${source})glsl\"},\n")
+endforeach()
+
+string(APPEND content "};\n\n")
+string(APPEND content "const size_t embedded_shader_count = sizeof(embedded_shaders) / sizeof(embedded_shaders[0]);\n")
+
+# Left untouched when nothing changed, so the generated file does not trigger a rebuild
+if(EXISTS "${OUTPUT}")
+    file(READ "${OUTPUT}" previous)
+endif()
+
+if(NOT "${previous}" STREQUAL "${content}")
+    file(WRITE "${OUTPUT}" "${content}")
+endif()
@@ -0,0 +1,8 @@
+#pragma once
+
+#include <cstddef>
+
+// Number of operator new calls made by the calling thread. Only available when the
+// CircleSkinningAllocationCounter target is linked, which replaces the global operator new.
+size_t get_allocation_count();
+size_t get_allocated_bytes();
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+
+struct BatchRenderOptions
+{
+    // Text file with one scene file path per line, empty lines and # comments are skipped
+    std::string list_path;
+    // Images are named after their scene file, the directory is created when missing
+    std::string output_directory;
+    int width = 1920;
+    int height = 1080;
+    // png or ppm
+    std::string format = "png";
+};
+
+// Skins and renders every scene of the list into an image without opening a window. Readback
+// and image writing overlap the rendering of the following scenes. Returns the exit code.
+int render_scene_batch(const BatchRenderOptions &options);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#define CAMERA_MIN_ZOOM 0.01f
+#define CAMERA_MAX_ZOOM 100.0f
+// Zoom factor of one scroll step
+#define CAMERA_ZOOM_STEP 1.1f
+// Part of the window left empty around a fitted scene, on every side
+#define CAMERA_FIT_MARGIN 0.05f
+
+// Pan and zoom of the window over the scene, y pointing down in both. A window point p shows
+// the scene point offset + p / zoom, so the default camera maps window pixels to scene units.
+class Camera
+{
+public:
+    glm::vec2 offset = glm::vec2(0.0f);
+    float zoom = 1.0f;
+
+    glm::mat4 get_projection(float width, float height) const;
+    glm::vec2 window_to_scene(glm::vec2 point) const;
+    // Moves the scene along with a drag of delta window pixels
+    void pan(glm::vec2 delta);
+    // Scales the zoom by factor, keeping the scene point under the window point in place
+    void zoom_at(glm::vec2 point, float factor);
+    // Centres the scene box low .. high in a window of the given size and zooms to fit it
+    void fit(glm::vec2 low, glm::vec2 high, float width, float height);
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <skinning.hpp>
+#include <vector>
+
+// Shapes of the generated chains the benchmarks and tests skin
+enum class ChainKind
+{
+    // Random walk with neighbours about touching
+    Random,
+    // Centres on a line with a tiny jitter, the radical lines become nearly parallel
+    NearlyCollinear,
+    // Neighbours overlapping most of their radius
+    Overlapping,
+    // Radii alternating between MIN_CIRCLE_SIZE and MAX_CIRCLE_SIZE
+    RadiusExtremes,
+};
+
+const char *get_chain_kind_name(ChainKind kind);
+// A seed gives the same chain within one standard library only, the distributions and
+// glm::cos/sin are not fixed across implementations
+std::vector<SkinCircle> generate_chain(ChainKind kind, size_t count, unsigned int seed);
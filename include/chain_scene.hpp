@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <skinning.hpp>
+#include <span>
+#include <vector>
+
+class ThreadPool;
+
+// Any number of independent open chains, stored back to back. Chain c owns the circles
+// get_chain_starts()[c] .. get_chain_starts()[c + 1] - 1 and the skin points with the same
+// indices, its curves follow the curves of the chains before it, left curves first. Points of
+// chains with fewer than two circles are left at the circle centres.
+//
+// Every chain has its own SkinningContext and dirty state, so an edit only recomputes the
+// chain it was made in. update_skins runs the dirty chains in parallel when a pool is set.
+class ChainScene
+{
+private:
+    std::vector<SkinCircle> circles;
+    // One more entry than chains, the last one is the circle count
+    std::vector<size_t> chain_starts = { 0 };
+    std::vector<size_t> curve_starts = { 0 };
+    std::vector<SkinningContext> contexts;
+    std::vector<uint8_t> chain_dirty;
+    std::vector<size_t> updated_chains;
+    SkinStorage skin;
+    size_t closed_form_fallbacks = 0;
+
+    void resize_chain(size_t chain, size_t index, bool inserted);
+    SkinBuffers get_chain_buffers(size_t chain);
+    void skin_chain(size_t chain, ThreadPool *chain_thread_pool);
+public:
+    // Skins dirty chains in parallel, or a single dirty chain with the pool inside the chain.
+    // Must not be used by anything else while update_skins runs.
+    ThreadPool *thread_pool = nullptr;
+
+    void clear();
+    // Replaces the scene, chain_starts as returned by get_chain_starts
+    void assign(std::span<const SkinCircle> circles, std::span<const size_t> chain_starts);
+
+    size_t get_chain_count() const;
+    size_t get_circle_count() const;
+    // Chain the circle at index belongs to
+    size_t get_chain_of(size_t index) const;
+    std::span<const size_t> get_chain_starts() const;
+    // Where the curves of every chain start in get_skin().curves, one more entry than chains
+    std::span<const size_t> get_curve_starts() const;
+    std::span<const SkinCircle> get_circles() const;
+    std::span<const SkinCircle> get_chain_circles(size_t chain) const;
+
+    // Appends an empty chain and returns its index
+    size_t add_chain();
+    // Appends a circle to the end of a chain and returns its index in the whole scene. Circles
+    // of the later chains move up by one.
+    size_t append_circle(size_t chain, const SkinCircle &circle);
+    // Removes a circle, an emptied chain stays in place so chain indices do not change
+    void erase_circle(size_t index);
+    void set_circle(size_t index, const SkinCircle &circle);
+    void mark_all_dirty();
+
+    // Skins every chain changed since the last call and returns how many there were
+    size_t update_skins();
+    // Chains recomputed by the last update_skins
+    std::span<const size_t> get_updated_chains() const;
+    // Part of the chain recomputed by the last update_skins, relative to the chain start
+    SkinWindow get_updated_window(size_t chain) const;
+    const SkinStorage &get_skin() const;
+    // Summed over the chains of the last update_skins
+    size_t get_closed_form_fallbacks() const;
+};
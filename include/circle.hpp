@@ -0,0 +1,21 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#define BALL_COLOR glm::vec3(0.0f, 1.0f, 0.0f)
+#define MAX_CIRCLE_SIZE 150.0f
+#define MIN_CIRCLE_SIZE 5.0f
+
+class Circle
+{
+public:
+    float radius;
+    glm::vec2 position;
+    glm::vec3 color;
+    Circle(float r, glm::vec2 pos, glm::vec3 color = BALL_COLOR)
+    {
+        this->position = pos;
+        this->radius = r;
+        this->color = color;
+    }
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <unordered_map>
+#include <vector>
+
+// Edge length of a grid cell in scene units, circles up to MAX_CIRCLE_SIZE span at most 4x4 cells
+#define CIRCLE_GRID_CELL_SIZE 128.0f
+// Circles covering more cells are kept in a list every lookup scans instead
+#define CIRCLE_GRID_MAX_CELLS_PER_CIRCLE 64
+// Cell coordinates are clamped to this, so any finite position fits an int
+#define CIRCLE_GRID_MAX_CELL_COORDINATE (1 << 24)
+
+// Uniform grid over circle bounds for picking. Circles are identified by their index in the
+// caller's list and every operation mirrors an edit of that list. Circles with a non-finite
+// position or radius are kept for the numbering but can never be picked.
+class CircleGrid
+{
+private:
+    struct CellRange
+    {
+        int min_x;
+        int min_y;
+        int max_x;
+        int max_y;
+    };
+
+    struct GridCircle
+    {
+        glm::vec2 position;
+        float radius;
+        CellRange cells;
+    };
+
+    std::vector<GridCircle> circles;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+    // Circles larger than CIRCLE_GRID_MAX_CELLS_PER_CIRCLE cells, in no cell
+    std::vector<uint32_t> large_circles;
+
+    static uint64_t get_cell_key(int x, int y);
+    // Empty for circles that can not be picked, the full range for large ones
+    static CellRange get_cell_range(glm::vec2 position, float radius);
+    static bool is_large(const CellRange &range);
+    // Cells of range outside of skip, which may be empty
+    void add_to_cells(uint32_t index, const CellRange &range, const CellRange &skip);
+    void remove_from_cells(uint32_t index, const CellRange &range, const CellRange &skip);
+    void add_circle(uint32_t index, const CellRange &range);
+    void remove_circle(uint32_t index, const CellRange &range);
+    void renumber(size_t index, int delta);
+public:
+    void clear();
+    size_t size() const;
+
+    // Appends a circle, as push_back on the list
+    void push_back(glm::vec2 position, float radius);
+    // Inserts a circle and renumbers the ones after it, as insert on the list
+    void insert(size_t index, glm::vec2 position, float radius);
+    // A circle was moved or resized, only cells it entered or left are touched. Circles moving
+    // into or out of the large list are removed and added again.
+    void update(size_t index, glm::vec2 position, float radius);
+    // Removes a circle and renumbers the ones after it, as erase on the list
+    void erase(size_t index);
+
+    // Lowest index of the circles containing the point, or -1. This is the circle a linear
+    // scan of the list would find first.
+    int find_first(glm::vec2 point) const;
+};
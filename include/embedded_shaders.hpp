@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+struct EmbeddedShader
+{
+    // File name in src, e.g. "fragment.glsl"
+    const char *name;
+    const char *source;
+};
+
+// Every src/*.glsl, generated into the build directory by cmake/embed_shaders.cmake
+extern const EmbeddedShader embedded_shaders[];
+extern const size_t embedded_shader_count;
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <chrono>
+#include <glad/glad.h>
+
+#define GPU_STAGE_COUNT 2
+// Frames in flight before a slot is reused, results are read back this many frames late at most
+#define GPU_TIMER_RING_SIZE 4
+
+enum class GpuStage
+{
+    Circles,
+    Curves,
+};
+
+struct GpuFrameTimes
+{
+    double stage_milliseconds[GPU_STAGE_COUNT];
+    // When the GPU finished the frame, on the CPU clock
+    std::chrono::steady_clock::time_point finished;
+    // Whatever the caller passed to end_frame, e.g. the input the frame shows
+    std::chrono::steady_clock::time_point tag;
+};
+
+// GL_TIME_ELAPSED queries per stage and a GL_TIMESTAMP query at the end of every frame, kept
+// in a ring so results are only read once available and never stall the pipeline. Frames
+// whose slot is still in flight are not timed.
+class GpuTimers
+{
+private:
+    struct Slot
+    {
+        unsigned int elapsed_queries[GPU_STAGE_COUNT];
+        unsigned int timestamp_query;
+        bool stage_used[GPU_STAGE_COUNT];
+        bool pending;
+        std::chrono::steady_clock::time_point tag;
+    };
+
+    Slot slots[GPU_TIMER_RING_SIZE] = {};
+    size_t frame_index = 0;
+    size_t oldest_pending = 0;
+    bool frame_active = false;
+    bool initialized = false;
+
+    // GPU timestamp minus CPU time, in nanoseconds
+    int64_t clock_offset = 0;
+
+    void calibrate();
+public:
+    void initialize();
+    void destroy();
+
+    void begin_frame();
+    void begin(GpuStage stage);
+    void end();
+    void end_frame(std::chrono::steady_clock::time_point tag = {});
+
+    // Oldest finished frame not returned yet, false when the next one is still running
+    bool poll(GpuFrameTimes &times);
+};
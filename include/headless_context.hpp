@@ -0,0 +1,23 @@
+#pragma once
+
+struct GLFWwindow;
+
+// GL 4.1 core context without anything on screen, for rendering into framebuffer objects.
+// A surfaceless EGL context where EGL is available, which also runs without a display server
+// (e.g. Mesa's llvmpipe), otherwise the context of a hidden GLFW window.
+class HeadlessContext
+{
+private:
+    void *display = nullptr;
+    void *context = nullptr;
+    GLFWwindow *window = nullptr;
+public:
+    HeadlessContext() = default;
+    ~HeadlessContext();
+    HeadlessContext(const HeadlessContext &) = delete;
+    HeadlessContext &operator=(const HeadlessContext &) = delete;
+
+    // Makes the context current and loads the GL functions
+    bool initialize();
+    void destroy();
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Images waiting for the writer thread before submit blocks
+#define IMAGE_WRITER_MAX_QUEUED 8
+
+// Writes RGBA8 pixels, rows from top to bottom, as an RGB image. The format follows the
+// extension: binary PPM for .ppm, PNG with uncompressed deflate blocks for anything else.
+bool write_image_file(const std::string &path, int width, int height, const std::vector<uint8_t> &pixels);
+
+// Writes images on its own thread so encoding and disk I/O overlap the rendering of the next
+// frames. The queue is bounded, a writer falling behind slows submit down instead of growing.
+class ImageWriter
+{
+private:
+    struct Job
+    {
+        std::string path;
+        int width;
+        int height;
+        std::vector<uint8_t> pixels;
+    };
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<Job> jobs;
+    // Pixel buffers of written images, handed out again by get_buffer
+    std::vector<std::vector<uint8_t>> free_buffers;
+    size_t failed_count = 0;
+    bool stopping = false;
+
+    void worker_loop();
+public:
+    ~ImageWriter();
+
+    void start();
+    // Writes everything still queued before it returns
+    void stop();
+
+    // An empty vector, with the capacity of an earlier image when there is one
+    std::vector<uint8_t> get_buffer();
+    void submit(const std::string &path, int width, int height, std::vector<uint8_t> &&pixels);
+    // Images that could not be written so far
+    size_t get_failed_count();
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define INPUT_TRACE_MAGIC "CSKI"
+#define INPUT_TRACE_VERSION 1
+
+enum class InputEventType : uint8_t
+{
+    CursorPosition,
+    MouseButton,
+    Scroll,
+};
+
+// Trace layout, little-endian: this header followed by 16-byte events up to the end of the file
+struct InputTraceHeader
+{
+    char magic[4];
+    uint32_t version;
+    // Framebuffer size when recording started, cursor positions are window coordinates in it
+    float window_width;
+    float window_height;
+    // Circles of the scene recording started from, replay has to load the same scene
+    uint64_t circle_count;
+};
+
+// One callback call, x and y are the cursor position or the scroll offsets
+struct InputEvent
+{
+    // Since the previous event, the first one since recording started
+    uint32_t delta_microseconds;
+    InputEventType type;
+    uint8_t button;
+    uint8_t action;
+    uint8_t mods;
+    float x;
+    float y;
+};
+
+// Appends events to a trace file as they arrive, timed with the steady clock
+class InputTraceRecorder
+{
+private:
+    std::ofstream file;
+    std::chrono::steady_clock::time_point start_time;
+    // Sum of the recorded deltas, so rounding never makes the trace drift from the clock
+    uint64_t recorded_microseconds = 0;
+    size_t event_count = 0;
+
+    void add(InputEventType type, uint8_t button, uint8_t action, uint8_t mods, float x, float y);
+public:
+    bool open(const std::string &path, float window_width, float window_height, uint64_t circle_count);
+    bool is_open() const;
+    size_t get_event_count() const;
+    void add_cursor_position(double x, double y);
+    void add_mouse_button(int button, int action, int mods);
+    void add_scroll(double x_offset, double y_offset);
+    // False when any write failed
+    bool close();
+};
+
+// Fails on a missing file, a bad header or a partial event at the end
+bool read_input_trace(const std::string &path, InputTraceHeader &header, std::vector<InputEvent> &events);
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <string>
+
+#define LATENCY_BUCKET_MILLISECONDS 0.5
+// Samples above the last bucket are counted in it
+#define LATENCY_BUCKET_COUNT 200
+
+class LatencyHistogram
+{
+private:
+    unsigned int buckets[LATENCY_BUCKET_COUNT] = {};
+    unsigned int sample_count = 0;
+    double max_milliseconds = 0.0;
+    double total_milliseconds = 0.0;
+public:
+    void add(double milliseconds);
+    unsigned int get_sample_count() const;
+    // Upper bound of the bucket the percentile falls into
+    double get_percentile(double percentile) const;
+    // Summary line followed by one row per non-empty bucket
+    std::string get_report(const std::string &name) const;
+};
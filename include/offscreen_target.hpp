@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <glad/glad.h>
+#include <vector>
+
+// Frames read back at the same time, the one rendered last is copied out this many frames late
+#define OFFSCREEN_PBO_COUNT 3
+
+// RGBA8 pixels, rows from top to bottom
+struct OffscreenImage
+{
+    uint64_t tag = 0;
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+// Framebuffer object of any size with a ring of pixel buffer objects for asynchronous
+// readback. read_back only queues the copy into the next buffer, acquire maps a buffer once
+// its fence signalled, so rendering the next frame overlaps the transfer of the last one.
+class OffscreenTarget
+{
+private:
+    struct Slot
+    {
+        unsigned int pbo;
+        GLsync fence;
+        uint64_t tag;
+    };
+
+    unsigned int framebuffer = 0;
+    unsigned int color_renderbuffer = 0;
+    int width = 0;
+    int height = 0;
+    Slot slots[OFFSCREEN_PBO_COUNT] = {};
+    size_t frame_index = 0;
+    size_t oldest_pending = 0;
+public:
+    // Fails when the framebuffer is incomplete, e.g. larger than the implementation allows
+    bool initialize(int width, int height);
+    void destroy();
+    int get_width() const;
+    int get_height() const;
+    // Draws go to the target and the viewport covers it until unbind
+    void bind();
+    void unbind();
+
+    // Frames read back but not acquired yet, read_back needs fewer than OFFSCREEN_PBO_COUNT
+    size_t get_pending_count() const;
+    // Queues the copy of what was rendered so far, tag comes back with the image
+    bool read_back(uint64_t tag);
+    // Oldest frame read back and not returned yet. Without wait it is false while the copy runs.
+    bool acquire(OffscreenImage &image, bool wait);
+};
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+// Scalar types of the templated geometry functions, picked at compile time. Inputs and results
+// are stored as storage_type, the arithmetic in between runs in compute_type.
+template <typename Storage, typename Compute>
+struct PrecisionPolicy
+{
+    using storage_type = Storage;
+    using compute_type = Compute;
+    using storage_vec2 = glm::vec<2, Storage>;
+    using compute_vec2 = glm::vec<2, Compute>;
+};
+
+// The interactive path, bit-identical to the SIMD touching circle kernels
+using FloatPrecision = PrecisionPolicy<float, float>;
+// Float data with double arithmetic, for batch runs on large coordinates
+using MixedPrecision = PrecisionPolicy<float, double>;
+using DoublePrecision = PrecisionPolicy<double, double>;
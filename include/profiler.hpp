@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#define PROFILE_STAGE_COUNT 10
+// Frames the rolling statistics are taken over
+#define PROFILE_HISTORY_FRAMES 240
+
+enum class ProfileStage
+{
+    TouchingCircles,
+    Separation,
+    Tangents,
+    // Rebuilding the tile indices the renderer culls against
+    Culling,
+    Tessellation,
+    Upload,
+    Draw,
+    Frame,
+    // Reported by GPU timer queries a few frames late
+    GpuCircles,
+    GpuCurves,
+};
+
+struct ProfileStats
+{
+    double min_microseconds;
+    double average_microseconds;
+    double p99_microseconds;
+};
+
+const char *get_profile_stage_name(ProfileStage stage);
+
+// Time spent per stage and frame. Stages running on several threads at once add up their
+// thread times, so they can exceed the wall time of the frame.
+class Profiler
+{
+private:
+    std::atomic<bool> enabled = false;
+    std::atomic<uint64_t> frame_nanoseconds[PROFILE_STAGE_COUNT] = {};
+
+    float history[PROFILE_STAGE_COUNT][PROFILE_HISTORY_FRAMES] = {};
+    size_t frame_count = 0;
+
+    std::ofstream csv;
+public:
+    void set_enabled(bool value);
+    bool is_enabled() const
+    {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    void add(ProfileStage stage, uint64_t nanoseconds)
+    {
+        frame_nanoseconds[(int)stage].fetch_add(nanoseconds, std::memory_order_relaxed);
+    }
+
+    // Moves the times of the finished frame into the history and the CSV file
+    void end_frame();
+    size_t get_frame_count() const;
+    ProfileStats get_stats(ProfileStage stage) const;
+
+    bool open_csv(const std::string &path);
+    void close_csv();
+};
+
+Profiler &get_profiler();
+
+// Adds the lifetime of the scope to a stage, costs one relaxed load while profiling is off
+class ScopedTimer
+{
+private:
+    ProfileStage stage;
+    bool active;
+    std::chrono::steady_clock::time_point start;
+public:
+    explicit ScopedTimer(ProfileStage stage) : stage(stage), active(get_profiler().is_enabled())
+    {
+        if (active)
+        {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedTimer()
+    {
+        stop();
+    }
+
+    // Ends the measurement before the end of the scope
+    void stop()
+    {
+        if (active)
+        {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            get_profiler().add(stage, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+            active = false;
+        }
+    }
+
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <glad/glad.h>
+#include <span>
+#include <string>
+
+struct ShaderStageSource
+{
+    GLenum type;
+    std::string source;
+};
+
+// Linked program binaries on disk, one file per program and driver. The key covers the GL
+// vendor, renderer and version strings besides the sources, so a driver update or another GPU
+// never loads a stale binary. The directory is $CIRCLE_SKINNING_SHADER_CACHE when set, else a
+// circle-skinning directory in the user's cache directory.
+std::filesystem::path get_program_cache_directory();
+uint64_t get_program_cache_key(std::span<const ShaderStageSource> stages);
+// A linked program, or 0 when there is no binary for the key or the driver rejects it
+unsigned int load_cached_program(uint64_t key);
+// program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+void store_cached_program(uint64_t key, unsigned int program);
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <circle.hpp>
+#include <cstdint>
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <gpu_timers.hpp>
+#include <skinning.hpp>
+#include <span>
+#include <string>
+#include <tile_index.hpp>
+#include <vector>
+
+// Shaders are looked up by their file name in src, see embedded_shaders.hpp. Programs come
+// from the program binary cache when the driver still accepts the stored binary, and compile
+// or link errors are printed and give 0.
+std::string read_shader(std::string name);
+unsigned int compile_shader(GLenum type, std::string name);
+unsigned int get_shader_program(std::string vertex_name, std::string fragment_name);
+unsigned int get_tessellation_shader_program(std::string vertex_name, std::string tess_control_name, std::string tess_eval_name, std::string fragment_name);
+
+enum class CurveRenderMode
+{
+    // Curves are evaluated on the CPU and uploaded as line strips
+    Cpu,
+    // Only the control data is uploaded, one patch per curve, and evaluated in hermite_tess_eval.glsl
+    Tessellation,
+};
+
+// 16 bytes per circle instead of 24, the color is normalized by the vertex fetch
+struct CircleInstance
+{
+    float x;
+    float y;
+    float radius;
+    uint8_t color[4];
+};
+
+// Curve vertices are 16-bit fixed point relative to the origin of their batch, 4 bytes instead of 20
+struct CurveVertex
+{
+    int16_t x;
+    int16_t y;
+};
+
+// Curves of one color whose vertices fit the fixed-point range around one origin, drawn with
+// one multi-draw call with the color and the origin as uniforms
+struct CurveDrawBatch
+{
+    glm::vec2 origin;
+    float step;
+    glm::vec3 color;
+    int first_curve;
+    int curve_count;
+};
+
+struct CurvePatch
+{
+    glm::vec2 p0;
+    glm::vec2 p1;
+    glm::vec2 v0;
+    glm::vec2 v1;
+    uint8_t color[4];
+};
+
+// Radius of the markers drawn at the skin points
+#define SKIN_POINT_SIZE 5.0f
+
+// Largest on-screen radius in pixels drawn as a point sprite. Points are clipped by their
+// center, so larger circles would pop at the edges of the window.
+#define CIRCLE_SPRITE_MAX_RADIUS 8.0f
+
+// Per-instance circle data packed into one buffer, circles drawn as quads first and point
+// sprites after them, each group with a single instanced call. Only circles in the tiles
+// around the view are uploaded.
+struct CircleBatch
+{
+    unsigned int vao = 0;
+    unsigned int instance_vbo = 0;
+    int instance_count = 0;
+    int sprite_count = 0;
+    float uploaded_scale = 0.0f;
+    TileIndex tiles;
+    TileRange uploaded_tiles = {0, 0, -1, -1};
+    bool dirty = true;
+};
+
+// Draws circles, skin markers and curves from shared GPU buffers. Every category is drawn
+// with one call and only re-uploaded after it was marked dirty or the view moved onto other
+// tiles. Anything outside those tiles is neither tessellated nor uploaded.
+class SceneRenderer
+{
+private:
+    unsigned int circle_program = 0;
+    unsigned int curve_program = 0;
+    GLint circle_projection_uniform = -1;
+    GLint circle_pixel_size_uniform = -1;
+    GLint circle_point_sprites_uniform = -1;
+    GLint curve_projection_uniform = -1;
+    GLint curve_origin_uniform = -1;
+    GLint curve_step_uniform = -1;
+    GLint curve_color_uniform = -1;
+
+    // Corners of the quad every circle is drawn on, as a triangle strip
+    unsigned int quad_vbo = 0;
+    float max_point_size = 1.0f;
+
+    CircleBatch circle_batch;
+    CircleBatch marker_batch;
+
+    unsigned int curve_vao = 0;
+    unsigned int curve_vbo = 0;
+    bool curves_dirty = true;
+    int tessellated_segments = 0;
+    float tessellated_tolerance = 0.0f;
+    float tessellated_scale = 0.0f;
+    TileRange tessellated_tiles = {0, 0, -1, -1};
+    std::vector<CurveVertex> curve_vertex_data;
+    std::vector<glm::vec2> curve_points;
+    std::vector<GLint> curve_firsts;
+    std::vector<GLsizei> curve_counts;
+    std::vector<CurveDrawBatch> curve_batches;
+
+    unsigned int hermite_program = 0;
+    GLint hermite_projection_uniform = -1;
+    GLint hermite_viewport_uniform = -1;
+    GLint hermite_segments_uniform = -1;
+    GLint hermite_tolerance_uniform = -1;
+
+    unsigned int patch_vao = 0;
+    unsigned int patch_vbo = 0;
+    bool patches_dirty = true;
+    int patch_count = 0;
+    TileRange patch_tiles = {0, 0, -1, -1};
+    std::vector<CurvePatch> patch_data;
+
+    // Shared by the left and right curves, they are culled the same way in both render modes
+    TileIndex curve_tiles;
+    bool curve_tiles_dirty = true;
+    std::vector<uint32_t> visible_objects;
+    std::vector<glm::vec2> bounds_low;
+    std::vector<glm::vec2> bounds_high;
+
+    CurveRenderMode curve_render_mode = CurveRenderMode::Cpu;
+
+    std::vector<CircleInstance> instance_data;
+
+    void create_circle_batch(CircleBatch &batch);
+    void build_circle_tiles(CircleBatch &batch, std::span<const Circle> circles);
+    void upload_circle_batch(CircleBatch &batch, std::span<const Circle> circles, float scale, const TileRange &tiles);
+    void render_circle_batch(CircleBatch &batch);
+    void build_curve_tiles(std::span<const HermiteCurve> curves);
+    void upload_curves(std::span<const HermiteCurve> curves, float scale, const TileRange &tiles);
+    void upload_patches(std::span<const HermiteCurve> curves, const TileRange &tiles);
+    void render_curve_strips(const glm::mat4 &projection);
+    void render_curve_patches(const glm::mat4 &projection);
+public:
+    // Fixed segment count per curve. When 0 every curve gets the fewest segments that keep it
+    // within curve_tolerance pixels of the exact curve on screen.
+    int curve_segments = 0;
+    // Times the circle and curve draws on the GPU when set
+    GpuTimers *gpu_timers = nullptr;
+    float curve_tolerance = 0.25f;
+
+    bool initialize();
+    void destroy();
+    void mark_circles_dirty();
+    void mark_skin_dirty();
+    bool supports_tessellation() const;
+    void set_curve_render_mode(CurveRenderMode mode);
+    CurveRenderMode get_curve_render_mode() const;
+    // Vertices of the curve polylines uploaded by the CPU path
+    size_t get_curve_vertex_count() const;
+    // Circles and skin markers, and curves, that survived culling in the last frame
+    size_t get_drawn_circle_count() const;
+    size_t get_drawn_curve_count() const;
+    void render(const glm::mat4 &projection, std::span<const Circle> circles, std::span<const Circle> point_circles, std::span<const HermiteCurve> curves);
+};
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <skinning.hpp>
+#include <span>
+#include <string>
+
+#define SCENE_FILE_MAGIC "CSKS"
+#define SKIN_FILE_MAGIC "CSKO"
+#define SCENE_FILE_VERSION 1
+// Circles skinned and written at once by skin_scene_file
+#define SKIN_FILE_CHUNK_CIRCLES 65536
+
+// Binary scene layout, little-endian: this header followed by circle_count positions (x, y
+// float pairs) at positions_offset and circle_count float radii at radii_offset. Both offsets
+// are 16-byte aligned so the arrays can be used straight from a mapping.
+struct SceneFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t circle_count;
+    uint64_t positions_offset;
+    uint64_t radii_offset;
+};
+
+// Skin output layout: this header, then left points, right points (x, y float pairs, one per
+// circle), left curves and right curves (p0, p1, v0, v1 as 8 floats, one per neighbouring
+// pair), each array starting at the offset in the header.
+struct SkinFileHeader
+{
+    char magic[4];
+    uint32_t version;
+    uint64_t circle_count;
+    uint64_t left_points_offset;
+    uint64_t right_points_offset;
+    uint64_t left_curves_offset;
+    uint64_t right_curves_offset;
+};
+
+// Read-only mapping of a binary scene file, the arrays point into the mapping
+class MappedSceneFile
+{
+private:
+    void *data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void *file_handle = nullptr;
+    void *mapping_handle = nullptr;
+#endif
+    std::span<const glm::vec2> positions;
+    std::span<const float> radii;
+public:
+    MappedSceneFile() = default;
+    ~MappedSceneFile();
+    MappedSceneFile(const MappedSceneFile &) = delete;
+    MappedSceneFile &operator=(const MappedSceneFile &) = delete;
+
+    // Fails on a missing file, a bad header, arrays reaching past the end of the file or circles
+    // with a non-finite position or a radius that is not positive and finite
+    bool open(const std::string &path);
+    void close();
+
+    size_t get_circle_count() const;
+    std::span<const glm::vec2> get_positions() const;
+    std::span<const float> get_radii() const;
+};
+
+bool write_scene_file(const std::string &path, std::span<const SkinCircle> circles);
+// Converts a text scene, one "x y radius" line per circle with # comments, streaming it
+bool import_text_scene(const std::string &text_path, const std::string &scene_path);
+bool is_scene_file(const std::string &path);
+
+// Skins a scene chunk by chunk into a skin file, memory use does not grow with the scene.
+// With mixed_precision the geometry runs in double on the float scene, which is slower but
+// holds up better for scenes far from the origin.
+bool skin_scene_file(const MappedSceneFile &scene, const std::string &output_path, size_t chunk_circles = SKIN_FILE_CHUNK_CIRCLES, bool mixed_precision = false);
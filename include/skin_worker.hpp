@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <chain_scene.hpp>
+#include <skinning.hpp>
+#include <span>
+#include <thread>
+#include <triple_buffer.hpp>
+#include <utility>
+#include <vector>
+
+struct SkinInput
+{
+    std::vector<SkinCircle> circles;
+    // As ChainScene::get_chain_starts
+    std::vector<size_t> chain_starts;
+    uint32_t generation = 0;
+};
+
+// Ranges waiting for the render thread before the next result sends the whole skin instead
+#define SKIN_WORKER_MAX_PENDING_RANGES 1024
+
+// Inclusive range of skin point or curve indices in the whole scene
+struct SkinRange
+{
+    size_t first;
+    size_t last;
+};
+
+// Changes of the skin since the last result the render thread acquired. Results acquired
+// before are still applied, so only the ranges recomputed since then are sent along.
+struct SkinResult
+{
+    // Value submit returned for the snapshot this skin belongs to
+    uint32_t generation = 0;
+    // Worker pass that produced it
+    uint64_t pass = 0;
+    // Circles the skin was calculated for, laid out as in ChainScene
+    size_t circle_count = 0;
+    std::vector<size_t> chain_starts;
+    // Circles of this pass that needed the search over all sign combinations
+    size_t closed_form_fallbacks = 0;
+    // The whole skin is in skin, e.g. after the chains changed. Otherwise skin holds the
+    // points of point_ranges and the curves of curve_ranges back to back.
+    bool full = true;
+    std::vector<SkinRange> point_ranges;
+    std::vector<SkinRange> curve_ranges;
+    SkinStorage skin;
+};
+
+// Calculates skins on a background thread. The render thread submits snapshots of the circles
+// and picks up finished skins without ever waiting for the calculation; snapshots submitted
+// while the worker is busy are coalesced into the latest one.
+class SkinWorker
+{
+private:
+    std::thread thread;
+    std::atomic<uint32_t> submitted_generation = 0;
+    std::atomic<bool> stopping = false;
+
+    TripleBuffer<SkinInput> inputs;
+    TripleBuffer<SkinResult> results;
+
+    // Pass of the result the render thread acquired last
+    std::atomic<uint64_t> acquired_pass = 0;
+
+    // Owned by the worker thread
+    ChainScene scene;
+    bool scene_valid = false;
+    uint64_t pass = 0;
+    // Last pass that replaced the whole skin, and the ranges of the passes after it that the
+    // render thread may not have seen yet, each tagged with its pass
+    uint64_t full_pass = 0;
+    std::vector<std::pair<uint64_t, SkinRange>> pending_point_ranges;
+    std::vector<std::pair<uint64_t, SkinRange>> pending_curve_ranges;
+
+    void worker_loop(uint32_t seen_generation);
+    // Returns false when the whole skin was replaced
+    bool calculate(const SkinInput &input);
+    void add_pending_ranges();
+    void fill_result(SkinResult &result);
+public:
+    // Called on the worker thread after a result was published, e.g. to wake up the event loop
+    void (*result_callback)() = nullptr;
+    // Used by the worker thread for the chains, must not be used elsewhere while the worker runs
+    ThreadPool *thread_pool = nullptr;
+
+    SkinWorker() = default;
+    ~SkinWorker();
+    SkinWorker(const SkinWorker &) = delete;
+    SkinWorker &operator=(const SkinWorker &) = delete;
+
+    void start();
+    void stop();
+    bool is_running() const;
+
+    // Returns an increasing number identifying the snapshot in results
+    uint32_t submit(std::span<const SkinCircle> circles, std::span<const size_t> chain_starts);
+    // Newest finished skin, or nullptr when there is none since the last call. The result stays
+    // valid until the next call and has to be applied, later results only carry the ranges
+    // changed after it.
+    const SkinResult *acquire_result();
+};
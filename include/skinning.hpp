@@ -0,0 +1,223 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <optional>
+#include <precision_policy.hpp>
+#include <span>
+#include <touching_circle_kernel.hpp>
+#include <tuple>
+#include <vector>
+
+#define LEFT_COLOR glm::vec3(1.0f, 0.0f, 0.0f)
+#define RIGHT_COLOR glm::vec3(0.0f, 0.0f, 1.0f)
+#define MAX_CURVE_SEGMENTS 64
+// Triples whose touching circle is centred closer than this to where it touches the middle
+// circle are left to the search over all sign combinations, the side it touches from is unclear
+#define CLOSED_FORM_MIN_DISTANCE 0.1f
+
+template <typename T>
+struct BasicSkinCircle
+{
+    glm::vec<2, T> position;
+    T radius;
+};
+
+using SkinCircle = BasicSkinCircle<float>;
+
+template <typename T>
+struct BasicTouchingCircle
+{
+    T radius;
+    glm::vec<2, T> position;
+};
+
+using TouchingCircle = BasicTouchingCircle<float>;
+
+struct CircleExternalTangentPoints
+{
+    glm::vec2 c1_p1;
+    glm::vec2 c2_p1;
+    glm::vec2 c1_p2;
+    glm::vec2 c2_p2;
+};
+
+template <typename T>
+struct BasicRadicalLine
+{
+    T a;
+    T b;
+    T c;
+};
+
+using RadicalLine = BasicRadicalLine<float>;
+
+struct SeparatedPoints
+{
+    glm::vec2 left_point;
+    glm::vec2 right_point;
+};
+
+class HermiteCurve
+{
+private:
+    glm::vec2 p0;
+    glm::vec2 p1;
+    glm::vec2 v0;
+    glm::vec2 v1;
+    glm::vec3 color;
+    glm::vec2 hermite(glm::vec2 p_cur, glm::vec2 p_next, glm::vec2 v_cur, glm::vec2 v_next, float t) const;
+public:
+    HermiteCurve() = default;
+    HermiteCurve(glm::vec2 p0, glm::vec2 p1, glm::vec2 v0, glm::vec2 v1, glm::vec3 color);
+    std::vector<float> get_vertex_data(int segments) const;
+    void append_vertex_data(std::vector<float> &data, int segments) const;
+    void append_points(std::vector<glm::vec2> &points, int segments) const;
+    glm::vec2 get_p0() const;
+    glm::vec2 get_p1() const;
+    glm::vec2 get_v0() const;
+    glm::vec2 get_v1() const;
+    glm::vec3 get_color() const;
+    // Box around the control points of the equivalent cubic Bezier curve, which contains the curve
+    void get_bounds(glm::vec2 &low, glm::vec2 &high) const;
+    // Fewest uniform segments keeping the polyline within tolerance of the curve, both measured
+    // after scaling the curve by scale. Clamped to 1 .. MAX_CURVE_SEGMENTS.
+    int get_segment_count(float tolerance, float scale = 1.0f) const;
+};
+
+// Caller-owned output of one skinned chain. For n circles left_points and right_points
+// hold n points each, curves holds the n - 1 left curves followed by the n - 1 right curves.
+struct SkinBuffers
+{
+    std::span<glm::vec2> left_points;
+    std::span<glm::vec2> right_points;
+    std::span<HermiteCurve> curves;
+};
+
+// Inclusive index ranges of the skin points and curves rewritten by an update. A range is
+// empty when first > last.
+struct SkinWindow
+{
+    size_t first_point;
+    size_t last_point;
+    size_t first_curve;
+    size_t last_curve;
+};
+
+size_t skin_point_count(size_t circle_count);
+size_t skin_curve_count(size_t circle_count);
+SkinWindow get_skin_window(size_t circle_count, size_t first_circle, size_t last_circle);
+
+// The functions templated on a PrecisionPolicy are instantiated for FloatPrecision,
+// MixedPrecision and DoublePrecision, and default to FloatPrecision. Those taking chains of
+// SkinCircle only exist for the float-stored policies.
+template <typename Precision = FloatPrecision>
+std::optional<BasicTouchingCircle<typename Precision::storage_type>> find_touching_circle(
+    const BasicSkinCircle<typename Precision::storage_type> &c1,
+    const BasicSkinCircle<typename Precision::storage_type> &c2,
+    const BasicSkinCircle<typename Precision::storage_type> &c3,
+    int s1, int s2, int s3);
+CircleExternalTangentPoints get_tangent_points(glm::vec2 c1_pos, float r1, glm::vec2 c2_pos, float r2);
+bool get_if_circles_touch_externally_or_internally(glm::vec2 common_circle_pos, float common_circle_radius, glm::vec2 circle_pos, float circle_radius);
+std::tuple<glm::vec2, glm::vec2> select_curve_points(std::span<const SkinCircle> circles, int index, std::span<const std::optional<TouchingCircle>> touching_circles);
+// The touching circles with the signs (1, 1, 1) and (-1, -1, -1) are the only ones touching all
+// three circles the same way, the ones select_curve_points is meant to keep, without its 0.1
+// tolerance. When one of them has no solution the result is the tangent points the search falls
+// back to as well. Returns nullopt for the degenerate cases the search has to decide.
+std::optional<std::tuple<glm::vec2, glm::vec2>> select_closed_form_curve_points(std::span<const SkinCircle> circles, int index, const std::optional<TouchingCircle> &outer, const std::optional<TouchingCircle> &inner);
+// Tries all eight sign combinations and filters them with select_curve_points
+template <typename Precision = FloatPrecision>
+std::tuple<glm::vec2, glm::vec2> search_curve_points_for_circle(std::span<const SkinCircle> circles, int index);
+// Solves the outer and inner touching circle only and falls back to the search when the closed
+// form does not apply
+template <typename Precision = FloatPrecision>
+std::tuple<glm::vec2, glm::vec2> find_curve_points_for_circle(std::span<const SkinCircle> circles, int index);
+template <typename Precision = FloatPrecision>
+BasicRadicalLine<typename Precision::storage_type> get_radical_line(
+    typename Precision::storage_vec2 c1_pos, typename Precision::storage_type r1,
+    typename Precision::storage_vec2 c2_pos, typename Precision::storage_type r2);
+template <typename Precision = FloatPrecision>
+typename Precision::storage_vec2 find_radical_center(
+    typename Precision::storage_vec2 c1_pos, typename Precision::storage_type r1,
+    typename Precision::storage_vec2 c2_pos, typename Precision::storage_type r2,
+    typename Precision::storage_vec2 c3_pos, typename Precision::storage_type r3);
+glm::vec2 rotate_vector(glm::vec2 vec, float angle);
+glm::vec2 flip_when_facing_opposite(glm::vec2 vec, glm::vec2 check_against);
+template <typename Precision = FloatPrecision>
+std::tuple<typename Precision::storage_vec2, typename Precision::storage_vec2> calculate_tangents(
+    typename Precision::storage_vec2 c1_pos, typename Precision::storage_type r1,
+    typename Precision::storage_vec2 c2_pos, typename Precision::storage_type r2,
+    typename Precision::storage_vec2 point1, typename Precision::storage_vec2 point2);
+template <typename Precision = FloatPrecision>
+SeparatedPoints separate_points(glm::vec2 point1, glm::vec2 point2, std::span<const SkinCircle> circles, int index);
+SeparatedPoints separate_end_points(glm::vec2 point1, glm::vec2 point2, glm::vec2 chain_from, glm::vec2 chain_to);
+
+// Output buffers that are kept between passes. resize only reallocates when a chain grows
+// past the largest size seen so far, so steady-state skinning does not touch the heap.
+struct SkinStorage
+{
+    std::vector<glm::vec2> left_points;
+    std::vector<glm::vec2> right_points;
+    std::vector<HermiteCurve> curves;
+    void resize(size_t circle_count);
+    SkinBuffers get_buffers();
+};
+
+// Working memory of one thread skinning a run of interior circles, kept between passes
+struct SkinScratch
+{
+    std::vector<float> soa_x;
+    std::vector<float> soa_y;
+    std::vector<float> soa_radius;
+    std::vector<float> touching_x;
+    std::vector<float> touching_y;
+    std::vector<float> touching_radius;
+    std::vector<uint8_t> touching_valid;
+    size_t closed_form_fallbacks = 0;
+};
+
+class ThreadPool;
+
+// Skins chains of circles without touching any global state. A context must not be shared
+// between threads, but any number of contexts can run at the same time.
+//
+// For interactive editing the context also remembers which circles changed since the chain
+// was last skinned. update_skin then only recomputes the points and curves next to them and
+// keeps the rest of the output buffers from the previous pass.
+class SkinningContext
+{
+private:
+    size_t skinned_circle_count = 0;
+    bool all_dirty = true;
+    size_t dirty_first = SIZE_MAX;
+    size_t dirty_last = 0;
+    SkinWindow updated_window = {1, 0, 1, 0};
+    size_t closed_form_fallbacks = 0;
+    std::vector<SkinScratch> scratches;
+    template <typename Precision>
+    void calculate_interior_points(std::span<const SkinCircle> circles, const SkinBuffers &output, int first, int last, SkinScratch &scratch);
+    template <typename Precision>
+    void calculate_curves(std::span<const SkinCircle> circles, const SkinBuffers &output, int first, int last);
+    template <typename Precision>
+    void calculate_window(std::span<const SkinCircle> circles, const SkinBuffers &output, const SkinWindow &window);
+public:
+    // Instruction set of the batched touching circle solve, the widest available by default
+    KernelIsa kernel_isa = get_best_kernel_isa();
+    // When set, windows longer than parallel_grain circles are split into chunks of that many
+    // circles and skinned on the pool. The output is the same as the serial one.
+    ThreadPool *thread_pool = nullptr;
+    size_t parallel_grain = 4096;
+    // Instantiated for FloatPrecision and MixedPrecision. Only the float policy goes through the
+    // SIMD kernels, the mixed one solves every circle with the scalar code in double.
+    template <typename Precision = FloatPrecision>
+    bool calculate_skin(std::span<const SkinCircle> circles, const SkinBuffers &output);
+    size_t calculate_skins(std::span<const std::span<const SkinCircle>> chains, std::span<const SkinBuffers> outputs);
+    void mark_dirty(size_t index);
+    void mark_dirty(size_t first, size_t last);
+    void mark_all_dirty();
+    bool update_skin(std::span<const SkinCircle> circles, const SkinBuffers &output);
+    const SkinWindow &get_updated_window() const;
+    // Interior circles of the last pass whose curve points needed the search over all sign
+    // combinations instead of the closed form
+    size_t get_closed_form_fallbacks() const;
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#define TEXT_FIRST_GLYPH 32
+#define TEXT_GLYPH_COUNT 95
+#define TEXT_ATLAS_WIDTH 512
+
+struct Glyph
+{
+    glm::vec2 size;
+    glm::vec2 bearing;
+    float advance;
+    glm::vec2 atlas_min;
+    glm::vec2 atlas_max;
+};
+
+// Printable ASCII text drawn from a glyph atlas rasterized once with Freetype
+class TextOverlay
+{
+private:
+    unsigned int program = 0;
+    GLint projection_uniform = -1;
+    GLint color_uniform = -1;
+
+    unsigned int atlas_texture = 0;
+    unsigned int vao = 0;
+    unsigned int vbo = 0;
+
+    Glyph glyphs[TEXT_GLYPH_COUNT];
+    float line_height = 0.0f;
+
+    std::vector<float> vertex_data;
+
+    bool load_atlas(const std::string &font_path, int pixel_size);
+public:
+    bool initialize(const std::string &font_path, int pixel_size);
+    void destroy();
+    bool is_initialized() const;
+
+    // Lines are separated by '\n', position is the top left corner in pixels
+    void draw(const glm::mat4 &projection, std::string_view text, glm::vec2 position, glm::vec3 color);
+};
+
+// First font of a few common system locations that exists, empty when none does
+std::string find_overlay_font();
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+// Fixed set of worker threads running chunked loops. Every worker owns a queue of chunks and
+// steals from the front of the other queues once its own is empty. The thread calling
+// parallel_for joins in as the last worker, so bodies see worker indices 0 .. get_worker_count() - 1.
+// Only one parallel_for runs at a time and bodies must not start another one.
+class ThreadPool
+{
+private:
+    using JobFunction = void (*)(void *context, size_t begin, size_t end, size_t worker);
+
+    struct Chunk
+    {
+        size_t begin;
+        size_t end;
+    };
+
+    struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::vector<Chunk> chunks;
+        size_t head = 0;
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+    std::mutex job_mutex;
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    uint64_t job_generation = 0;
+    bool stopping = false;
+
+    JobFunction job_function = nullptr;
+    void *job_context = nullptr;
+    std::atomic<size_t> remaining_chunks = 0;
+
+    bool pop_chunk(size_t worker, Chunk &chunk);
+    bool run_chunk(size_t worker);
+    void worker_loop(size_t worker);
+    void run(size_t begin, size_t end, size_t grain, JobFunction function, void *context);
+public:
+    // Number of threads besides the caller, one less than the hardware threads by default
+    explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency() > 1 ? std::thread::hardware_concurrency() - 1 : 0);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    size_t get_worker_count() const;
+
+    // Calls body(chunk_begin, chunk_end, worker) for chunks of at most grain indices covering
+    // [begin, end) and returns once all of them finished.
+    template <typename Body>
+    void parallel_for(size_t begin, size_t end, size_t grain, Body &&body)
+    {
+        run(begin, end, grain, [](void *context, size_t chunk_begin, size_t chunk_end, size_t worker)
+        {
+            (*static_cast<std::remove_reference_t<Body> *>(context))(chunk_begin, chunk_end, worker);
+        }, (void *)&body);
+    }
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+// Edge length of a culling tile in scene units
+#define RENDER_TILE_SIZE 512.0f
+// Scenes wider than this many tiles get larger tiles instead
+#define MAX_RENDER_TILES_PER_AXIS 256
+
+// Inclusive tile coordinates, empty when min > max
+struct TileRange
+{
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+
+    bool operator==(const TileRange &other) const = default;
+};
+
+// Coarse grid over object bounds for view culling. Unlike CircleGrid it is rebuilt as a whole
+// after a change, with the objects of every tile stored back to back, which is cheaper than
+// updating a map for the many objects a skin pass moves.
+class TileIndex
+{
+private:
+    glm::vec2 origin = glm::vec2(0.0f);
+    float tile_size = RENDER_TILE_SIZE;
+    int columns = 0;
+    int rows = 0;
+    std::vector<TileRange> object_tiles;
+    // Objects of tile y * columns + x are tile_objects[tile_starts[tile] .. tile_starts[tile + 1] - 1]
+    std::vector<uint32_t> tile_starts;
+    std::vector<uint32_t> tile_objects;
+public:
+    // Object i covers low[i] .. high[i]. Objects with bounds that are not finite are left out.
+    void build(std::span<const glm::vec2> low, std::span<const glm::vec2> high);
+    size_t size() const;
+    // Tiles overlapping the rectangle, clamped to the grid
+    TileRange get_tile_range(glm::vec2 low, glm::vec2 high) const;
+    // Replaces objects with the objects in the tiles of range, each once and in increasing order
+    void query(const TileRange &range, std::vector<uint32_t> &objects) const;
+};
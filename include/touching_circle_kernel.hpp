@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+#define TOUCHING_CIRCLE_COMBINATIONS 8
+// The all-positive and the all-negative sign combination, see find_touching_circles
+#define TOUCHING_CIRCLE_PAIR 2
+
+enum class KernelIsa
+{
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+// Structure-of-arrays output of find_touching_circles. Each array holds
+// TOUCHING_CIRCLE_PAIR * count entries.
+struct TouchingCircleArrays
+{
+    std::span<float> x;
+    std::span<float> y;
+    std::span<float> radius;
+    std::span<uint8_t> valid;
+};
+
+// Solves the outer and inner touching circle for the triples centred on the circles
+// first .. first + count - 1, so first must be at least 1 and first + count at most the circle
+// count - 1. The result for the triple centred on first + i is stored at i for the signs
+// (1, 1, 1) and at count + i for (-1, -1, -1). Both come out of one solve: negating every sign
+// negates a1, b1 and C1 exactly, so the second circle is the other root of the same quadratic.
+// The results are bit-identical to find_touching_circle with those signs on every ISA.
+void find_touching_circles(KernelIsa isa, std::span<const float> x, std::span<const float> y, std::span<const float> radius, size_t first, size_t count, const TouchingCircleArrays &output);
+void find_touching_circles(std::span<const float> x, std::span<const float> y, std::span<const float> radius, size_t first, size_t count, const TouchingCircleArrays &output);
+
+// The widest ISA supported by both the build and the running CPU
+KernelIsa get_best_kernel_isa();
+const char * get_kernel_isa_name(KernelIsa isa);
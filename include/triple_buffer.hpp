@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+
+// Lock-free handoff of values from one producer thread to one consumer thread. The producer
+// fills the write slot and publishes it, the consumer picks up the latest published slot.
+// Neither side ever waits for the other, values published in between are skipped.
+template <typename T>
+class TripleBuffer
+{
+private:
+    static constexpr int FRESH_BIT = 4;
+    static constexpr int INDEX_MASK = 3;
+
+    T slots[3];
+    std::atomic<int> middle_index = 1;
+    int write_index = 0;
+    int read_index = 2;
+public:
+    T &get_write_slot()
+    {
+        return slots[write_index];
+    }
+
+    void publish()
+    {
+        write_index = middle_index.exchange(write_index | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Latest published value, or nullptr when nothing was published since the last call
+    T *acquire()
+    {
+        if ((middle_index.load(std::memory_order_relaxed) & FRESH_BIT) == 0)
+        {
+            return nullptr;
+        }
+
+        read_index = middle_index.exchange(read_index, std::memory_order_acq_rel) & INDEX_MASK;
+        return &slots[read_index];
+    }
+
+    T &get_read_slot()
+    {
+        return slots[read_index];
+    }
+};
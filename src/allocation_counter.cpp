@@ -0,0 +1,54 @@
+#include <allocation_counter.hpp>
+#include <cstdlib>
+#include <new>
+
+thread_local size_t allocation_count = 0;
+thread_local size_t allocated_bytes = 0;
+
+size_t get_allocation_count()
+{
+    return allocation_count;
+}
+
+size_t get_allocated_bytes()
+{
+    return allocated_bytes;
+}
+
+void * operator new(size_t size)
+{
+    allocation_count++;
+    allocated_bytes += size;
+
+    if (auto pointer = std::malloc(size == 0 ? 1 : size))
+    {
+        return pointer;
+    }
+
+    throw std::bad_alloc();
+}
+
+void * operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
@@ -0,0 +1,191 @@
+#include <glad/glad.h>
+#include <batch_render.hpp>
+#include <camera.hpp>
+#include <chain_scene.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fmt/core.h>
+#include <fstream>
+#include <headless_context.hpp>
+#include <image_writer.hpp>
+#include <offscreen_target.hpp>
+#include <renderer.hpp>
+#include <scene_file.hpp>
+#include <thread_pool.hpp>
+#include <vector>
+
+static std::vector<std::string> read_scene_list(const std::string &path)
+{
+    std::vector<std::string> scenes;
+    std::ifstream file(path);
+    std::string line;
+
+    while (std::getline(file, line))
+    {
+        line = line.substr(0, line.find('#'));
+
+        auto first = line.find_first_not_of(" \t\r");
+        auto last = line.find_last_not_of(" \t\r");
+
+        if (first != std::string::npos)
+        {
+            scenes.push_back(line.substr(first, last - first + 1));
+        }
+    }
+
+    return scenes;
+}
+
+int render_scene_batch(const BatchRenderOptions &options)
+{
+    auto scenes = read_scene_list(options.list_path);
+
+    if (scenes.empty())
+    {
+        fmt::println("No scenes listed in {}", options.list_path);
+        return 1;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(options.output_directory, error);
+
+    HeadlessContext context;
+
+    if (!context.initialize())
+    {
+        fmt::println("Failed to create a headless GL 4.1 context");
+        return 1;
+    }
+
+    SceneRenderer renderer;
+    OffscreenTarget target;
+
+    if (!renderer.initialize())
+    {
+        fmt::println("Failed to create shader programs");
+        return 1;
+    }
+
+    if (!target.initialize(options.width, options.height))
+    {
+        fmt::println("Failed to create a {}x{} framebuffer", options.width, options.height);
+        renderer.destroy();
+        return 1;
+    }
+
+    ImageWriter writer;
+    writer.start();
+
+    ThreadPool thread_pool;
+    ChainScene scene;
+    scene.thread_pool = &thread_pool;
+
+    std::vector<std::string> output_paths(scenes.size());
+    std::vector<SkinCircle> skin_circles;
+    std::vector<Circle> circles;
+    std::vector<Circle> point_circles;
+    OffscreenImage image;
+    size_t failed_scenes = 0;
+
+    auto write_image = [&]
+    {
+        writer.submit(output_paths[image.tag], image.width, image.height, std::move(image.pixels));
+        image.pixels = writer.get_buffer();
+    };
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+    for (size_t i = 0; i < scenes.size(); i++)
+    {
+        MappedSceneFile scene_file;
+
+        if (!scene_file.open(scenes[i]))
+        {
+            fmt::println("Failed to open scene {}", scenes[i]);
+            failed_scenes++;
+            continue;
+        }
+
+        auto positions = scene_file.get_positions();
+        auto radii = scene_file.get_radii();
+
+        skin_circles.clear();
+        circles.clear();
+        point_circles.clear();
+
+        auto low = positions.empty() ? glm::vec2(0.0f) : positions[0];
+        auto high = low;
+
+        for (size_t j = 0; j < positions.size(); j++)
+        {
+            skin_circles.push_back(SkinCircle{positions[j], radii[j]});
+            circles.push_back(Circle(radii[j], positions[j]));
+            low = glm::min(low, positions[j] - glm::vec2(radii[j]));
+            high = glm::max(high, positions[j] + glm::vec2(radii[j]));
+        }
+
+        size_t chain_starts[] = { 0, skin_circles.size() };
+
+        scene.assign(skin_circles, chain_starts);
+        scene.update_skins();
+
+        auto &skin = scene.get_skin();
+
+        for (size_t j = 0; j < skin.left_points.size() && skin_circles.size() >= 2; j++)
+        {
+            point_circles.push_back(Circle(SKIN_POINT_SIZE, skin.left_points[j], LEFT_COLOR));
+            point_circles.push_back(Circle(SKIN_POINT_SIZE, skin.right_points[j], RIGHT_COLOR));
+        }
+
+        Camera camera;
+        camera.fit(low, high, options.width, options.height);
+
+        target.bind();
+        glClear(GL_COLOR_BUFFER_BIT);
+
+        renderer.mark_circles_dirty();
+        renderer.mark_skin_dirty();
+        renderer.render(camera.get_projection(options.width, options.height), circles, point_circles, skin.curves);
+
+        // Every buffer still holds an earlier frame, the oldest one has to be copied out first
+        if (target.get_pending_count() == OFFSCREEN_PBO_COUNT && target.acquire(image, true))
+        {
+            write_image();
+        }
+
+        auto stem = std::filesystem::path(scenes[i]).stem().string();
+
+        output_paths[i] = (std::filesystem::path(options.output_directory) / (stem + "." + options.format)).string();
+        target.read_back(i);
+
+        while (target.acquire(image, false))
+        {
+            write_image();
+        }
+    }
+
+    while (target.acquire(image, true))
+    {
+        write_image();
+    }
+
+    writer.stop();
+
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    auto rendered = scenes.size() - failed_scenes;
+
+    fmt::println("Rendered {} scenes at {}x{} in {:.2f} s, {:.1f} scenes/s", rendered, options.width, options.height, seconds, rendered / seconds);
+
+    if (writer.get_failed_count() > 0)
+    {
+        fmt::println("Failed to write {} images to {}", writer.get_failed_count(), options.output_directory);
+    }
+
+    target.unbind();
+    target.destroy();
+    renderer.destroy();
+
+    return failed_scenes > 0 || writer.get_failed_count() > 0 ? 1 : 0;
+}
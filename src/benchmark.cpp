@@ -0,0 +1,404 @@
+#include <algorithm>
+#include <allocation_counter.hpp>
+#include <chain_generator.hpp>
+#include <chain_scene.hpp>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <fmt/core.h>
+#include <skinning.hpp>
+#include <string>
+#include <string_view>
+#include <thread_pool.hpp>
+#include <touching_circle_kernel.hpp>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#define DEFAULT_SEED 1234
+#define DEFAULT_MIN_TIME 0.25
+#define SAMPLE_COUNT 5
+#define BENCHMARK_CURVE_SEGMENTS 30
+// Chains the circles of a size are split into for the ChainScene benchmark
+#define BENCHMARK_SCENE_CHAINS 64
+
+size_t get_peak_memory_bytes()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+#if defined(__APPLE__)
+    return usage.ru_maxrss;
+#else
+    return usage.ru_maxrss * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+struct BenchmarkResult
+{
+    std::string benchmark;
+    std::string variant;
+    const char *chain;
+    size_t circles;
+    size_t iterations;
+    double min_nanoseconds;
+    double median_nanoseconds;
+    double allocations;
+    double allocated_bytes;
+    size_t peak_memory_bytes;
+};
+
+// Keeps results of the measured code observable, so the optimizer cannot drop it
+volatile float benchmark_sink;
+
+// Runs body until min_time passed, SAMPLE_COUNT times, and reports nanoseconds per call
+template <typename Body>
+BenchmarkResult run_benchmark(std::string benchmark, std::string variant, ChainKind kind, size_t circles, double min_time, Body &&body)
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Warms up caches and lets every buffer reach its steady-state size
+    body();
+
+    size_t iterations = 1;
+
+    while (true)
+    {
+        auto start = Clock::now();
+
+        for (size_t i = 0; i < iterations; i++)
+        {
+            body();
+        }
+
+        auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        if (elapsed >= min_time / SAMPLE_COUNT || iterations >= (1u << 30))
+        {
+            break;
+        }
+
+        iterations *= 2;
+    }
+
+    double samples[SAMPLE_COUNT];
+    auto allocations = get_allocation_count();
+    auto allocated_bytes = get_allocated_bytes();
+
+    for (auto &sample : samples)
+    {
+        auto start = Clock::now();
+
+        for (size_t i = 0; i < iterations; i++)
+        {
+            body();
+        }
+
+        sample = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations;
+    }
+
+    auto total_iterations = (double)(iterations * SAMPLE_COUNT);
+
+    std::sort(samples, samples + SAMPLE_COUNT);
+
+    return BenchmarkResult{
+        benchmark, variant, get_chain_kind_name(kind), circles, iterations * SAMPLE_COUNT,
+        samples[0], samples[SAMPLE_COUNT / 2],
+        (get_allocation_count() - allocations) / total_iterations,
+        (get_allocated_bytes() - allocated_bytes) / total_iterations,
+        get_peak_memory_bytes()};
+}
+
+void run_chain_benchmarks(std::vector<BenchmarkResult> &results, ChainKind kind, size_t count, unsigned int seed, double min_time, ThreadPool &thread_pool)
+{
+    auto chain = generate_chain(kind, count, seed);
+
+    SkinStorage skin;
+    skin.resize(chain.size());
+
+    SkinningContext context;
+
+    // The scalar kernel is the reference the SIMD kernels are compared against
+    for (auto isa : { KernelIsa::Scalar, KernelIsa::Sse2, KernelIsa::Avx2 })
+    {
+        if ((int)isa > (int)get_best_kernel_isa())
+        {
+            continue;
+        }
+
+        context.kernel_isa = isa;
+
+        results.push_back(run_benchmark("calculate_skin", get_kernel_isa_name(isa), kind, count, min_time, [&]
+        {
+            context.calculate_skin(chain, skin.get_buffers());
+            benchmark_sink = skin.left_points.back().x;
+        }));
+    }
+
+    if (thread_pool.get_worker_count() > 1)
+    {
+        context.kernel_isa = get_best_kernel_isa();
+        context.thread_pool = &thread_pool;
+
+        results.push_back(run_benchmark("calculate_skin", fmt::format("{}_threads_{}", get_kernel_isa_name(context.kernel_isa), thread_pool.get_worker_count()), kind, count, min_time, [&]
+        {
+            context.calculate_skin(chain, skin.get_buffers());
+            benchmark_sink = skin.left_points.back().x;
+        }));
+
+        context.thread_pool = nullptr;
+    }
+
+    results.push_back(run_benchmark("find_curve_points_for_circle", "scalar", kind, count, min_time, [&]
+    {
+        float sum = 0.0f;
+
+        for (size_t i = 1; i + 1 < chain.size(); i++)
+        {
+            sum += std::get<0>(find_curve_points_for_circle(chain, i)).x;
+        }
+
+        benchmark_sink = sum;
+    }));
+
+    results.push_back(run_benchmark("search_curve_points_for_circle", "scalar", kind, count, min_time, [&]
+    {
+        float sum = 0.0f;
+
+        for (size_t i = 1; i + 1 < chain.size(); i++)
+        {
+            sum += std::get<0>(search_curve_points_for_circle(chain, i)).x;
+        }
+
+        benchmark_sink = sum;
+    }));
+
+    results.push_back(run_benchmark("find_touching_circle", "scalar", kind, count, min_time, [&]
+    {
+        float sum = 0.0f;
+
+        for (size_t i = 1; i + 1 < chain.size(); i++)
+        {
+            for (auto k = 0; k < TOUCHING_CIRCLE_COMBINATIONS; k++)
+            {
+                auto touching_circle = find_touching_circle(chain[i - 1], chain[i], chain[i + 1], k & 1 ? -1 : 1, k & 2 ? -1 : 1, k & 4 ? -1 : 1);
+
+                if (touching_circle)
+                {
+                    sum += touching_circle->radius;
+                }
+            }
+        }
+
+        benchmark_sink = sum;
+    }));
+
+    results.push_back(run_benchmark("get_vertex_data", fmt::format("segments_{}", BENCHMARK_CURVE_SEGMENTS), kind, count, min_time, [&]
+    {
+        float sum = 0.0f;
+
+        for (auto &curve : skin.curves)
+        {
+            sum += curve.get_vertex_data(BENCHMARK_CURVE_SEGMENTS).back();
+        }
+
+        benchmark_sink = sum;
+    }));
+}
+
+void run_scene_benchmarks(std::vector<BenchmarkResult> &results, ChainKind kind, size_t count, unsigned int seed, double min_time, ThreadPool &thread_pool)
+{
+    auto chain_length = std::max(count / BENCHMARK_SCENE_CHAINS, (size_t)3);
+
+    std::vector<SkinCircle> circles;
+    std::vector<size_t> chain_starts = { 0 };
+
+    for (auto chain = 0; chain < BENCHMARK_SCENE_CHAINS; chain++)
+    {
+        auto chain_circles = generate_chain(kind, chain_length, seed + chain);
+
+        circles.insert(circles.end(), chain_circles.begin(), chain_circles.end());
+        chain_starts.push_back(circles.size());
+    }
+
+    ChainScene scene;
+    scene.assign(circles, chain_starts);
+
+    // Every chain is dirty in every iteration, so this is the throughput of a full scene update
+    results.push_back(run_benchmark("chain_scene_update", "serial", kind, circles.size(), min_time, [&]
+    {
+        scene.mark_all_dirty();
+        scene.update_skins();
+        benchmark_sink = scene.get_skin().left_points.back().x;
+    }));
+
+    if (thread_pool.get_worker_count() > 1)
+    {
+        scene.thread_pool = &thread_pool;
+
+        results.push_back(run_benchmark("chain_scene_update", fmt::format("threads_{}", thread_pool.get_worker_count()), kind, circles.size(), min_time, [&]
+        {
+            scene.mark_all_dirty();
+            scene.update_skins();
+            benchmark_sink = scene.get_skin().left_points.back().x;
+        }));
+    }
+}
+
+void print_json(const std::vector<BenchmarkResult> &results, unsigned int seed)
+{
+    fmt::println("{{");
+    fmt::println("  \"seed\": {},", seed);
+    fmt::println("  \"best_kernel_isa\": \"{}\",", get_kernel_isa_name(get_best_kernel_isa()));
+    fmt::println("  \"results\": [");
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        auto &result = results[i];
+
+        fmt::println(
+            "    {{\"benchmark\": \"{}\", \"variant\": \"{}\", \"chain\": \"{}\", \"circles\": {}, \"iterations\": {}, "
+            "\"min_ns\": {:.1f}, \"median_ns\": {:.1f}, \"circles_per_second\": {:.0f}, "
+            "\"allocations_per_iteration\": {:.2f}, \"allocated_bytes_per_iteration\": {:.1f}, \"peak_memory_bytes\": {}}}{}",
+            result.benchmark, result.variant, result.chain, result.circles, result.iterations,
+            result.min_nanoseconds, result.median_nanoseconds, result.circles * 1e9 / result.median_nanoseconds,
+            result.allocations, result.allocated_bytes, result.peak_memory_bytes, i + 1 < results.size() ? "," : "");
+    }
+
+    fmt::println("  ]");
+    fmt::println("}}");
+}
+
+void print_csv(const std::vector<BenchmarkResult> &results)
+{
+    fmt::println("benchmark,variant,chain,circles,iterations,min_ns,median_ns,circles_per_second,allocations_per_iteration,allocated_bytes_per_iteration,peak_memory_bytes");
+
+    for (auto &result : results)
+    {
+        fmt::println("{},{},{},{},{},{:.1f},{:.1f},{:.0f},{:.2f},{:.1f},{}",
+            result.benchmark, result.variant, result.chain, result.circles, result.iterations,
+            result.min_nanoseconds, result.median_nanoseconds, result.circles * 1e9 / result.median_nanoseconds,
+            result.allocations, result.allocated_bytes, result.peak_memory_bytes);
+    }
+}
+
+// Parses a whole number, rejecting empty text and trailing characters
+template <typename T>
+bool parse_number(std::string_view text, T &value)
+{
+    auto end = text.data() + text.size();
+    auto [last, error] = std::from_chars(text.data(), end, value);
+
+    return error == std::errc() && last == end;
+}
+
+bool parse_sizes(const std::string &text, std::vector<size_t> &sizes)
+{
+    sizes.clear();
+    size_t start = 0;
+
+    while (start <= text.size())
+    {
+        auto end = text.find(',', start);
+
+        if (end == std::string::npos)
+        {
+            end = text.size();
+        }
+
+        size_t size;
+
+        if (!parse_number(std::string_view(text).substr(start, end - start), size))
+        {
+            return false;
+        }
+
+        sizes.push_back(size);
+        start = end + 1;
+    }
+
+    return true;
+}
+
+void print_usage()
+{
+    fmt::println("Usage: CircleSkinningBenchmark [--sizes 10,100,...] [--seed N] [--min-time SECONDS] [--format json|csv]");
+}
+
+int main(int argc, char **argv)
+{
+    std::vector<size_t> sizes = { 10, 100, 1000, 10000, 100000, 1000000 };
+    unsigned int seed = DEFAULT_SEED;
+    double min_time = DEFAULT_MIN_TIME;
+    bool csv = false;
+
+    for (auto i = 1; i < argc; i++)
+    {
+        auto argument = std::string(argv[i]);
+
+        if (i + 1 >= argc)
+        {
+            print_usage();
+            return 1;
+        }
+
+        auto valid = true;
+
+        if (argument == "--sizes")
+        {
+            valid = parse_sizes(argv[++i], sizes);
+        }
+        else if (argument == "--seed")
+        {
+            valid = parse_number(argv[++i], seed);
+        }
+        else if (argument == "--min-time")
+        {
+            valid = parse_number(argv[++i], min_time) && std::isfinite(min_time) && min_time > 0.0;
+        }
+        else if (argument == "--format")
+        {
+            csv = std::string(argv[++i]) == "csv";
+        }
+        else
+        {
+            valid = false;
+        }
+
+        if (!valid)
+        {
+            print_usage();
+            return 1;
+        }
+    }
+
+    ThreadPool thread_pool;
+    std::vector<BenchmarkResult> results;
+
+    for (auto kind : { ChainKind::Random, ChainKind::NearlyCollinear, ChainKind::Overlapping, ChainKind::RadiusExtremes })
+    {
+        for (auto size : sizes)
+        {
+            // Skinning needs at least three circles for an interior point
+            run_chain_benchmarks(results, kind, std::max(size, (size_t)3), seed, min_time, thread_pool);
+            run_scene_benchmarks(results, kind, size, seed, min_time, thread_pool);
+        }
+    }
+
+    if (csv)
+    {
+        print_csv(results);
+    }
+    else
+    {
+        print_json(results, seed);
+    }
+
+    return 0;
+}
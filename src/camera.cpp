@@ -0,0 +1,36 @@
+#include <camera.hpp>
+#include <glm/ext/matrix_clip_space.hpp>
+
+glm::mat4 Camera::get_projection(float width, float height) const
+{
+    auto size = glm::vec2(width, height) / zoom;
+
+    return glm::ortho(offset.x, offset.x + size.x, offset.y + size.y, offset.y, -1.0f, 1.0f);
+}
+
+glm::vec2 Camera::window_to_scene(glm::vec2 point) const
+{
+    return offset + point / zoom;
+}
+
+void Camera::pan(glm::vec2 delta)
+{
+    offset -= delta / zoom;
+}
+
+void Camera::zoom_at(glm::vec2 point, float factor)
+{
+    auto anchor = window_to_scene(point);
+
+    zoom = glm::clamp(zoom * factor, CAMERA_MIN_ZOOM, CAMERA_MAX_ZOOM);
+    offset = anchor - point / zoom;
+}
+
+void Camera::fit(glm::vec2 low, glm::vec2 high, float width, float height)
+{
+    auto extent = glm::max(high - low, glm::vec2(1.0f));
+    auto window = glm::vec2(width, height) * (1.0f - 2.0f * CAMERA_FIT_MARGIN);
+
+    zoom = glm::clamp(glm::min(window.x / extent.x, window.y / extent.y), CAMERA_MIN_ZOOM, CAMERA_MAX_ZOOM);
+    offset = (low + high) / 2.0f - glm::vec2(width, height) / (2.0f * zoom);
+}
@@ -0,0 +1,71 @@
+#include <chain_generator.hpp>
+#include <circle.hpp>
+#include <random>
+
+const char *get_chain_kind_name(ChainKind kind)
+{
+    switch (kind)
+    {
+        case ChainKind::Random: return "random";
+        case ChainKind::NearlyCollinear: return "nearly_collinear";
+        case ChainKind::Overlapping: return "overlapping";
+        case ChainKind::RadiusExtremes: return "radius_extremes";
+    }
+
+    return "unknown";
+}
+
+std::vector<SkinCircle> generate_chain(ChainKind kind, size_t count, unsigned int seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<SkinCircle> chain;
+    chain.reserve(count);
+
+    auto position = glm::vec2(0.0f);
+    auto direction = 0.0f;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        float radius;
+
+        switch (kind)
+        {
+            case ChainKind::RadiusExtremes:
+                radius = i % 2 == 0 ? MIN_CIRCLE_SIZE : MAX_CIRCLE_SIZE;
+                break;
+            default:
+                radius = MIN_CIRCLE_SIZE + unit(random) * (MAX_CIRCLE_SIZE - MIN_CIRCLE_SIZE) * 0.5f;
+                break;
+        }
+
+        if (i > 0)
+        {
+            auto previous_radius = chain.back().radius;
+            float distance;
+
+            switch (kind)
+            {
+                case ChainKind::NearlyCollinear:
+                    distance = previous_radius + radius;
+                    direction = (unit(random) - 0.5f) * 1e-3f;
+                    break;
+                case ChainKind::Overlapping:
+                    distance = (previous_radius + radius) * (0.1f + 0.2f * unit(random));
+                    direction += (unit(random) - 0.5f) * 1.0f;
+                    break;
+                default:
+                    distance = (previous_radius + radius) * (0.8f + 0.4f * unit(random));
+                    direction += (unit(random) - 0.5f) * 1.0f;
+                    break;
+            }
+
+            position += distance * glm::vec2(glm::cos(direction), glm::sin(direction));
+        }
+
+        chain.push_back(SkinCircle{position, radius});
+    }
+
+    return chain;
+}
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <chain_scene.hpp>
+#include <thread_pool.hpp>
+
+void ChainScene::clear()
+{
+    circles.clear();
+    chain_starts = { 0 };
+    curve_starts = { 0 };
+    contexts.clear();
+    chain_dirty.clear();
+    updated_chains.clear();
+    skin.resize(0);
+    closed_form_fallbacks = 0;
+}
+
+void ChainScene::assign(std::span<const SkinCircle> circles, std::span<const size_t> chain_starts)
+{
+    clear();
+
+    this->circles.assign(circles.begin(), circles.end());
+
+    for (size_t chain = 0; chain + 1 < chain_starts.size(); chain++)
+    {
+        auto count = chain_starts[chain + 1] - chain_starts[chain];
+
+        this->chain_starts.push_back(chain_starts[chain + 1]);
+        curve_starts.push_back(curve_starts.back() + skin_curve_count(count));
+    }
+
+    contexts.resize(get_chain_count());
+    chain_dirty.assign(get_chain_count(), 1);
+
+    skin.left_points.resize(this->circles.size());
+    skin.right_points.resize(this->circles.size());
+    skin.curves.resize(curve_starts.back());
+}
+
+size_t ChainScene::get_chain_count() const
+{
+    return chain_starts.size() - 1;
+}
+
+size_t ChainScene::get_circle_count() const
+{
+    return circles.size();
+}
+
+size_t ChainScene::get_chain_of(size_t index) const
+{
+    // Empty chains share their start with the next one, the last chain starting at or before
+    // the index is the one holding it
+    return std::upper_bound(chain_starts.begin(), chain_starts.end() - 1, index) - chain_starts.begin() - 1;
+}
+
+std::span<const size_t> ChainScene::get_chain_starts() const
+{
+    return chain_starts;
+}
+
+std::span<const size_t> ChainScene::get_curve_starts() const
+{
+    return curve_starts;
+}
+
+std::span<const SkinCircle> ChainScene::get_circles() const
+{
+    return circles;
+}
+
+std::span<const SkinCircle> ChainScene::get_chain_circles(size_t chain) const
+{
+    return std::span(circles).subspan(chain_starts[chain], chain_starts[chain + 1] - chain_starts[chain]);
+}
+
+size_t ChainScene::add_chain()
+{
+    chain_starts.push_back(circles.size());
+    curve_starts.push_back(curve_starts.back());
+    contexts.emplace_back();
+    chain_dirty.push_back(0);
+
+    return get_chain_count() - 1;
+}
+
+// The circle at index was inserted into or removed from the chain. Points and curves of the
+// later chains are shifted along with their circles, so their skins stay valid.
+void ChainScene::resize_chain(size_t chain, size_t index, bool inserted)
+{
+    auto old_count = chain_starts[chain + 1] - chain_starts[chain];
+    auto new_count = inserted ? old_count + 1 : old_count - 1;
+    auto curve_end = curve_starts[chain + 1];
+    auto curve_delta = (int64_t)skin_curve_count(new_count) - (int64_t)skin_curve_count(old_count);
+
+    for (auto i = chain + 1; i < chain_starts.size(); i++)
+    {
+        chain_starts[i] = inserted ? chain_starts[i] + 1 : chain_starts[i] - 1;
+        curve_starts[i] += curve_delta;
+    }
+
+    if (inserted)
+    {
+        skin.left_points.insert(skin.left_points.begin() + index, glm::vec2(0.0f));
+        skin.right_points.insert(skin.right_points.begin() + index, glm::vec2(0.0f));
+        skin.curves.insert(skin.curves.begin() + curve_end, (size_t)curve_delta, HermiteCurve());
+    }
+    else
+    {
+        skin.left_points.erase(skin.left_points.begin() + index);
+        skin.right_points.erase(skin.right_points.begin() + index);
+        skin.curves.erase(skin.curves.begin() + curve_end + curve_delta, skin.curves.begin() + curve_end);
+    }
+
+    contexts[chain].mark_all_dirty();
+    chain_dirty[chain] = 1;
+}
+
+size_t ChainScene::append_circle(size_t chain, const SkinCircle &circle)
+{
+    auto index = chain_starts[chain + 1];
+
+    circles.insert(circles.begin() + index, circle);
+    resize_chain(chain, index, true);
+
+    return index;
+}
+
+void ChainScene::erase_circle(size_t index)
+{
+    auto chain = get_chain_of(index);
+
+    circles.erase(circles.begin() + index);
+    resize_chain(chain, index, false);
+}
+
+void ChainScene::set_circle(size_t index, const SkinCircle &circle)
+{
+    auto chain = get_chain_of(index);
+
+    circles[index] = circle;
+    contexts[chain].mark_dirty(index - chain_starts[chain]);
+    chain_dirty[chain] = 1;
+}
+
+void ChainScene::mark_all_dirty()
+{
+    for (auto &context : contexts)
+    {
+        context.mark_all_dirty();
+    }
+
+    std::fill(chain_dirty.begin(), chain_dirty.end(), 1);
+}
+
+SkinBuffers ChainScene::get_chain_buffers(size_t chain)
+{
+    auto first = chain_starts[chain];
+    auto count = chain_starts[chain + 1] - first;
+    auto first_curve = curve_starts[chain];
+    auto curve_count = curve_starts[chain + 1] - first_curve;
+
+    return SkinBuffers{
+        std::span(skin.left_points).subspan(first, count),
+        std::span(skin.right_points).subspan(first, count),
+        std::span(skin.curves).subspan(first_curve, curve_count)};
+}
+
+void ChainScene::skin_chain(size_t chain, ThreadPool *chain_thread_pool)
+{
+    auto chain_circles = get_chain_circles(chain);
+    auto output = get_chain_buffers(chain);
+
+    if (chain_circles.size() < 2)
+    {
+        for (size_t i = 0; i < chain_circles.size(); i++)
+        {
+            output.left_points[i] = chain_circles[i].position;
+            output.right_points[i] = chain_circles[i].position;
+        }
+
+        contexts[chain].mark_all_dirty();
+        return;
+    }
+
+    contexts[chain].thread_pool = chain_thread_pool;
+    contexts[chain].update_skin(chain_circles, output);
+    contexts[chain].thread_pool = nullptr;
+}
+
+size_t ChainScene::update_skins()
+{
+    updated_chains.clear();
+
+    for (size_t chain = 0; chain < get_chain_count(); chain++)
+    {
+        if (chain_dirty[chain])
+        {
+            updated_chains.push_back(chain);
+            chain_dirty[chain] = 0;
+        }
+    }
+
+    // The pool runs one loop at a time, so it either spreads the chains over the workers or,
+    // for a single chain, the circles of that chain
+    if (thread_pool != nullptr && updated_chains.size() > 1)
+    {
+        thread_pool->parallel_for(0, updated_chains.size(), 1, [&](size_t begin, size_t end, size_t)
+        {
+            for (auto i = begin; i < end; i++)
+            {
+                skin_chain(updated_chains[i], nullptr);
+            }
+        });
+    }
+    else
+    {
+        for (auto chain : updated_chains)
+        {
+            skin_chain(chain, thread_pool);
+        }
+    }
+
+    closed_form_fallbacks = 0;
+
+    for (auto chain : updated_chains)
+    {
+        if (get_chain_circles(chain).size() >= 2)
+        {
+            closed_form_fallbacks += contexts[chain].get_closed_form_fallbacks();
+        }
+    }
+
+    return updated_chains.size();
+}
+
+std::span<const size_t> ChainScene::get_updated_chains() const
+{
+    return updated_chains;
+}
+
+SkinWindow ChainScene::get_updated_window(size_t chain) const
+{
+    auto count = chain_starts[chain + 1] - chain_starts[chain];
+
+    // Never went through the context, the points were set at the centres
+    if (count < 2)
+    {
+        return count == 1 ? SkinWindow{0, 0, 1, 0} : SkinWindow{1, 0, 1, 0};
+    }
+
+    return contexts[chain].get_updated_window();
+}
+
+const SkinStorage &ChainScene::get_skin() const
+{
+    return skin;
+}
+
+size_t ChainScene::get_closed_form_fallbacks() const
+{
+    return closed_form_fallbacks;
+}
@@ -0,0 +1,23 @@
+#version 410
+
+in vec3 vertexColor;
+in vec2 offset;
+flat in float extentInRadii;
+out vec4 FragColor;
+
+uniform bool point_sprites;
+
+void main()
+{
+    // Position relative to the center in radii, and the distance to the edge in pixels from it
+    vec2 position = point_sprites ? (gl_PointCoord * 2.0 - 1.0) * extentInRadii : offset;
+    float distance = length(position) - 1.0;
+    float coverage = clamp(0.5 - distance / max(fwidth(distance), 1e-6), 0.0, 1.0);
+
+    if (coverage == 0.0)
+    {
+        discard;
+    }
+
+    FragColor = vec4(vertexColor, coverage);
+}
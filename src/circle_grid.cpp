@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <circle_grid.hpp>
+#include <cmath>
+
+#define EMPTY_CELL_RANGE CellRange{1, 1, 0, 0}
+
+uint64_t CircleGrid::get_cell_key(int x, int y)
+{
+    return ((uint64_t)(uint32_t)x << 32) | (uint32_t)y;
+}
+
+static glm::vec2 get_cell_position(glm::vec2 point)
+{
+    auto limit = glm::vec2((float)CIRCLE_GRID_MAX_CELL_COORDINATE);
+
+    return glm::clamp(glm::floor(point / CIRCLE_GRID_CELL_SIZE), -limit, limit);
+}
+
+static bool contains(int min_x, int min_y, int max_x, int max_y, int x, int y)
+{
+    return x >= min_x && x <= max_x && y >= min_y && y <= max_y;
+}
+
+CircleGrid::CellRange CircleGrid::get_cell_range(glm::vec2 position, float radius)
+{
+    if (!std::isfinite(position.x) || !std::isfinite(position.y) || !std::isfinite(radius) || radius < 0.0f)
+    {
+        return EMPTY_CELL_RANGE;
+    }
+
+    auto min = get_cell_position(position - glm::vec2(radius));
+    auto max = get_cell_position(position + glm::vec2(radius));
+
+    return CellRange{(int)min.x, (int)min.y, (int)max.x, (int)max.y};
+}
+
+bool CircleGrid::is_large(const CellRange &range)
+{
+    auto width = (int64_t)range.max_x - range.min_x + 1;
+    auto height = (int64_t)range.max_y - range.min_y + 1;
+
+    return width > 0 && height > 0 && width * height > CIRCLE_GRID_MAX_CELLS_PER_CIRCLE;
+}
+
+void CircleGrid::add_to_cells(uint32_t index, const CellRange &range, const CellRange &skip)
+{
+    for (auto y = range.min_y; y <= range.max_y; y++)
+    {
+        for (auto x = range.min_x; x <= range.max_x; x++)
+        {
+            if (!contains(skip.min_x, skip.min_y, skip.max_x, skip.max_y, x, y))
+            {
+                cells[get_cell_key(x, y)].push_back(index);
+            }
+        }
+    }
+}
+
+void CircleGrid::remove_from_cells(uint32_t index, const CellRange &range, const CellRange &skip)
+{
+    for (auto y = range.min_y; y <= range.max_y; y++)
+    {
+        for (auto x = range.min_x; x <= range.max_x; x++)
+        {
+            if (contains(skip.min_x, skip.min_y, skip.max_x, skip.max_y, x, y))
+            {
+                continue;
+            }
+
+            auto cell = cells.find(get_cell_key(x, y));
+
+            if (cell == cells.end())
+            {
+                continue;
+            }
+
+            auto &indices = cell->second;
+            auto found = std::find(indices.begin(), indices.end(), index);
+
+            // Order inside a cell does not matter, find_first compares indices
+            if (found != indices.end())
+            {
+                *found = indices.back();
+                indices.pop_back();
+            }
+
+            if (indices.empty())
+            {
+                cells.erase(cell);
+            }
+        }
+    }
+}
+
+void CircleGrid::add_circle(uint32_t index, const CellRange &range)
+{
+    if (is_large(range))
+    {
+        large_circles.push_back(index);
+    }
+    else
+    {
+        add_to_cells(index, range, EMPTY_CELL_RANGE);
+    }
+}
+
+void CircleGrid::remove_circle(uint32_t index, const CellRange &range)
+{
+    if (is_large(range))
+    {
+        auto found = std::find(large_circles.begin(), large_circles.end(), index);
+
+        if (found != large_circles.end())
+        {
+            *found = large_circles.back();
+            large_circles.pop_back();
+        }
+    }
+    else
+    {
+        remove_from_cells(index, range, EMPTY_CELL_RANGE);
+    }
+}
+
+// Adds delta to every index from first on
+void CircleGrid::renumber(size_t first, int delta)
+{
+    for (auto &cell : cells)
+    {
+        for (auto &other : cell.second)
+        {
+            if (other >= first)
+            {
+                other += delta;
+            }
+        }
+    }
+
+    for (auto &other : large_circles)
+    {
+        if (other >= first)
+        {
+            other += delta;
+        }
+    }
+}
+
+void CircleGrid::clear()
+{
+    circles.clear();
+    cells.clear();
+    large_circles.clear();
+}
+
+size_t CircleGrid::size() const
+{
+    return circles.size();
+}
+
+void CircleGrid::push_back(glm::vec2 position, float radius)
+{
+    auto range = get_cell_range(position, radius);
+
+    circles.push_back(GridCircle{position, radius, range});
+    add_circle(circles.size() - 1, range);
+}
+
+void CircleGrid::insert(size_t index, glm::vec2 position, float radius)
+{
+    if (index == circles.size())
+    {
+        push_back(position, radius);
+        return;
+    }
+
+    renumber(index, 1);
+
+    auto range = get_cell_range(position, radius);
+
+    circles.insert(circles.begin() + index, GridCircle{position, radius, range});
+    add_circle(index, range);
+}
+
+void CircleGrid::update(size_t index, glm::vec2 position, float radius)
+{
+    auto &circle = circles[index];
+    auto range = get_cell_range(position, radius);
+    auto old_range = circle.cells;
+
+    circle.position = position;
+    circle.radius = radius;
+    circle.cells = range;
+
+    if (range.min_x == old_range.min_x && range.min_y == old_range.min_y && range.max_x == old_range.max_x && range.max_y == old_range.max_y)
+    {
+        return;
+    }
+
+    if (is_large(old_range) || is_large(range))
+    {
+        remove_circle(index, old_range);
+        add_circle(index, range);
+        return;
+    }
+
+    // Cells in both ranges keep the circle
+    remove_from_cells(index, old_range, range);
+    add_to_cells(index, range, old_range);
+}
+
+void CircleGrid::erase(size_t index)
+{
+    remove_circle(index, circles[index].cells);
+    circles.erase(circles.begin() + index);
+
+    // Linear like the erase on the circle list itself, removing is rare next to dragging
+    renumber(index + 1, -1);
+}
+
+int CircleGrid::find_first(glm::vec2 point) const
+{
+    if (!std::isfinite(point.x) || !std::isfinite(point.y))
+    {
+        return -1;
+    }
+
+    int first = -1;
+
+    auto check = [&](uint32_t index)
+    {
+        auto &circle = circles[index];
+
+        if ((first == -1 || (int)index < first) && glm::distance(point, circle.position) <= circle.radius)
+        {
+            first = index;
+        }
+    };
+
+    for (auto index : large_circles)
+    {
+        check(index);
+    }
+
+    auto cell_position = get_cell_position(point);
+    auto cell = cells.find(get_cell_key((int)cell_position.x, (int)cell_position.y));
+
+    if (cell != cells.end())
+    {
+        for (auto index : cell->second)
+        {
+            check(index);
+        }
+    }
+
+    return first;
+}
@@ -0,0 +1,38 @@
+#version 410
+
+layout (location = 0) in vec2 aCorner;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aCenter;
+layout (location = 3) in float aRadius;
+
+out vec3 vertexColor;
+out vec2 offset;
+// Half the quad or sprite size in radii
+flat out float extentInRadii;
+
+uniform mat4 projection;
+// Scene units per pixel
+uniform float pixel_size;
+// One point per circle instead of a quad of four corners
+uniform bool point_sprites;
+
+void main()
+{
+    // Grown by a pixel so the anti-aliased edge is not cut off
+    float extent = aRadius + pixel_size;
+
+    vertexColor = aColor;
+    extentInRadii = extent / aRadius;
+
+    if (point_sprites)
+    {
+        gl_Position = projection * vec4(aCenter, 1.0, 1.0);
+        gl_PointSize = 2.0 * extent / pixel_size;
+        offset = vec2(0.0);
+    }
+    else
+    {
+        gl_Position = projection * vec4(aCenter + aCorner * extent, 1.0, 1.0);
+        offset = aCorner * extentInRadii;
+    }
+}
@@ -0,0 +1,137 @@
+#include <gpu_timers.hpp>
+
+void GpuTimers::initialize()
+{
+    for (auto &slot : slots)
+    {
+        glGenQueries(GPU_STAGE_COUNT, slot.elapsed_queries);
+        glGenQueries(1, &slot.timestamp_query);
+    }
+
+    initialized = true;
+    calibrate();
+}
+
+void GpuTimers::destroy()
+{
+    if (!initialized)
+    {
+        return;
+    }
+
+    for (auto &slot : slots)
+    {
+        glDeleteQueries(GPU_STAGE_COUNT, slot.elapsed_queries);
+        glDeleteQueries(1, &slot.timestamp_query);
+        slot.pending = false;
+    }
+
+    initialized = false;
+}
+
+void GpuTimers::calibrate()
+{
+    GLint64 gpu_now;
+    glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+
+    auto cpu_now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+    clock_offset = gpu_now - cpu_now;
+}
+
+void GpuTimers::begin_frame()
+{
+    auto &slot = slots[frame_index % GPU_TIMER_RING_SIZE];
+
+    // Still in flight, waiting for it would stall so this frame goes untimed
+    frame_active = initialized && !slot.pending;
+
+    if (frame_active)
+    {
+        for (auto &used : slot.stage_used)
+        {
+            used = false;
+        }
+    }
+}
+
+void GpuTimers::begin(GpuStage stage)
+{
+    if (!frame_active)
+    {
+        return;
+    }
+
+    auto &slot = slots[frame_index % GPU_TIMER_RING_SIZE];
+
+    slot.stage_used[(int)stage] = true;
+    glBeginQuery(GL_TIME_ELAPSED, slot.elapsed_queries[(int)stage]);
+}
+
+void GpuTimers::end()
+{
+    if (frame_active)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+}
+
+void GpuTimers::end_frame(std::chrono::steady_clock::time_point tag)
+{
+    if (frame_active)
+    {
+        auto &slot = slots[frame_index % GPU_TIMER_RING_SIZE];
+
+        glQueryCounter(slot.timestamp_query, GL_TIMESTAMP);
+        slot.pending = true;
+        slot.tag = tag;
+        frame_index++;
+    }
+
+    frame_active = false;
+}
+
+bool GpuTimers::poll(GpuFrameTimes &times)
+{
+    if (oldest_pending == frame_index)
+    {
+        return false;
+    }
+
+    auto &slot = slots[oldest_pending % GPU_TIMER_RING_SIZE];
+
+    // The timestamp is the last query of the frame, once it is available all of them are
+    GLint available = 0;
+    glGetQueryObjectiv(slot.timestamp_query, GL_QUERY_RESULT_AVAILABLE, &available);
+
+    if (!available)
+    {
+        return false;
+    }
+
+    for (auto stage = 0; stage < GPU_STAGE_COUNT; stage++)
+    {
+        GLuint64 elapsed = 0;
+
+        if (slot.stage_used[stage])
+        {
+            glGetQueryObjectui64v(slot.elapsed_queries[stage], GL_QUERY_RESULT, &elapsed);
+        }
+
+        times.stage_milliseconds[stage] = elapsed / 1e6;
+    }
+
+    GLuint64 timestamp = 0;
+    glGetQueryObjectui64v(slot.timestamp_query, GL_QUERY_RESULT, &timestamp);
+
+    // Recalibrating on every read keeps drift between the two clocks out of the latencies
+    calibrate();
+
+    times.finished = std::chrono::steady_clock::time_point(std::chrono::nanoseconds((int64_t)timestamp - clock_offset));
+    times.tag = slot.tag;
+
+    slot.pending = false;
+    oldest_pending++;
+
+    return true;
+}
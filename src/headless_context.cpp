@@ -0,0 +1,130 @@
+#include <glad/glad.h>
+#include <GLFW/glfw3.h>
+#include <headless_context.hpp>
+
+#ifdef CIRCLE_SKINNING_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+static EGLDisplay get_egl_display()
+{
+    // Mesa's surfaceless platform needs neither X11, Wayland nor a GPU device node
+    auto get_platform_display = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+    if (get_platform_display != nullptr)
+    {
+        auto display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+
+        if (display != EGL_NO_DISPLAY)
+        {
+            return display;
+        }
+    }
+
+    return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+static bool create_egl_context(void *&display, void *&context)
+{
+    display = get_egl_display();
+
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr) || !eglBindAPI(EGL_OPENGL_API))
+    {
+        return false;
+    }
+
+    EGLint config_attributes[] = {
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_NONE,
+    };
+
+    EGLConfig config;
+    EGLint config_count = 0;
+
+    // Surfaceless displays may list no configs at all, the context then gets none
+    if (!eglChooseConfig(display, config_attributes, &config, 1, &config_count) || config_count == 0)
+    {
+        config = EGL_NO_CONFIG_KHR;
+    }
+
+    EGLint context_attributes[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 1,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE,
+    };
+
+    context = eglCreateContext(display, config, EGL_NO_CONTEXT, context_attributes);
+
+    if (context == EGL_NO_CONTEXT)
+    {
+        return false;
+    }
+
+    // Rendering only ever goes to framebuffer objects, so the context needs no surface
+    return eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)
+        && gladLoadGLLoader((GLADloadproc)eglGetProcAddress);
+}
+#endif
+
+HeadlessContext::~HeadlessContext()
+{
+    destroy();
+}
+
+bool HeadlessContext::initialize()
+{
+#ifdef CIRCLE_SKINNING_HAS_EGL
+    if (create_egl_context(display, context))
+    {
+        return true;
+    }
+
+    destroy();
+#endif
+
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 1);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    window = glfwCreateWindow(1, 1, "Circle skinning", nullptr, nullptr);
+
+    if (window == nullptr)
+    {
+        return false;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    return gladLoadGLLoader((GLADloadproc)glfwGetProcAddress);
+}
+
+void HeadlessContext::destroy()
+{
+#ifdef CIRCLE_SKINNING_HAS_EGL
+    if (display != nullptr)
+    {
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+
+        if (context != nullptr)
+        {
+            eglDestroyContext(display, context);
+        }
+
+        eglTerminate(display);
+    }
+#endif
+
+    if (window != nullptr)
+    {
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+
+    display = nullptr;
+    context = nullptr;
+    window = nullptr;
+}
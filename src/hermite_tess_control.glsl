@@ -0,0 +1,50 @@
+#version 410
+
+layout (vertices = 1) out;
+
+in vec4 controlPoints[];
+in vec4 controlTangents[];
+in vec3 controlColor[];
+
+out vec4 curvePoints[];
+out vec4 curveTangents[];
+out vec3 curveColor[];
+
+uniform mat4 projection;
+uniform vec2 viewport;
+uniform int segments;
+uniform float tolerance;
+
+vec2 to_screen(vec2 point)
+{
+    vec4 clip = projection * vec4(point, 1.0, 1.0);
+    return (clip.xy / clip.w * 0.5 + 0.5) * viewport;
+}
+
+void main()
+{
+    curvePoints[gl_InvocationID] = controlPoints[gl_InvocationID];
+    curveTangents[gl_InvocationID] = controlTangents[gl_InvocationID];
+    curveColor[gl_InvocationID] = controlColor[gl_InvocationID];
+
+    float level = float(segments);
+
+    if (segments <= 0)
+    {
+        // Wang's formula on the equivalent Bezier control points in screen space, same as HermiteCurve::get_segment_count
+        vec2 p0 = controlPoints[0].xy;
+        vec2 p1 = controlPoints[0].zw;
+
+        vec2 b0 = to_screen(p0);
+        vec2 b1 = to_screen(p0 + controlTangents[0].xy / 3.0);
+        vec2 b2 = to_screen(p1 - controlTangents[0].zw / 3.0);
+        vec2 b3 = to_screen(p1);
+
+        float m = max(length(b2 - 2.0 * b1 + b0), length(b3 - 2.0 * b2 + b1));
+
+        level = ceil(sqrt(0.75 * m / tolerance));
+    }
+
+    gl_TessLevelOuter[0] = 1.0;
+    gl_TessLevelOuter[1] = clamp(level, 1.0, 64.0);
+}
@@ -0,0 +1,28 @@
+#version 410
+
+layout (isolines, equal_spacing) in;
+
+in vec4 curvePoints[];
+in vec4 curveTangents[];
+in vec3 curveColor[];
+
+out vec3 vertexColor;
+
+uniform mat4 projection;
+
+void main()
+{
+    float t = gl_TessCoord.x;
+    float t2 = t * t;
+    float t3 = t2 * t;
+
+    float h0 = 2.0 * t3 - 3.0 * t2 + 1.0;
+    float h1 = -2.0 * t3 + 3.0 * t2;
+    float h2 = t3 - 2.0 * t2 + t;
+    float h3 = t3 - t2;
+
+    vec2 point = h0 * curvePoints[0].xy + h1 * curvePoints[0].zw + h2 * curveTangents[0].xy + h3 * curveTangents[0].zw;
+
+    gl_Position = projection * vec4(point, 1.0, 1.0);
+    vertexColor = curveColor[0];
+}
@@ -0,0 +1,16 @@
+#version 410
+
+layout (location = 0) in vec4 aPoints;
+layout (location = 1) in vec4 aTangents;
+layout (location = 2) in vec3 aColor;
+
+out vec4 controlPoints;
+out vec4 controlTangents;
+out vec3 controlColor;
+
+void main()
+{
+    controlPoints = aPoints;
+    controlTangents = aTangents;
+    controlColor = aColor;
+}
@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <fstream>
+#include <image_writer.hpp>
+
+static void append_be32(std::vector<uint8_t> &data, uint32_t value)
+{
+    data.push_back(value >> 24);
+    data.push_back(value >> 16);
+    data.push_back(value >> 8);
+    data.push_back(value);
+}
+
+static uint32_t get_crc32(const uint8_t *data, size_t size, uint32_t crc = 0)
+{
+    static const auto table = []
+    {
+        std::vector<uint32_t> table(256);
+
+        for (uint32_t i = 0; i < 256; i++)
+        {
+            auto value = i;
+
+            for (auto bit = 0; bit < 8; bit++)
+            {
+                value = value & 1 ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+            }
+
+            table[i] = value;
+        }
+
+        return table;
+    }();
+
+    crc = ~crc;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+static void write_png_chunk(std::ofstream &file, const char *type, const std::vector<uint8_t> &data)
+{
+    std::vector<uint8_t> chunk;
+
+    append_be32(chunk, data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    append_be32(chunk, get_crc32(chunk.data() + 4, chunk.size() - 4));
+
+    file.write((const char *)chunk.data(), chunk.size());
+}
+
+static bool write_png(std::ofstream &file, int width, int height, const std::vector<uint8_t> &pixels)
+{
+    static const uint8_t signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write((const char *)signature, sizeof(signature));
+
+    std::vector<uint8_t> header;
+    append_be32(header, width);
+    append_be32(header, height);
+    // 8-bit RGB, deflate, adaptive filtering, no interlacing
+    header.insert(header.end(), { 8, 2, 0, 0, 0 });
+    write_png_chunk(file, "IHDR", header);
+
+    // Every row starts with filter type 0
+    std::vector<uint8_t> rows;
+    rows.reserve((size_t)height * (width * 3 + 1));
+
+    for (int y = 0; y < height; y++)
+    {
+        rows.push_back(0);
+
+        for (int x = 0; x < width; x++)
+        {
+            auto pixel = &pixels[((size_t)y * width + x) * 4];
+            rows.insert(rows.end(), pixel, pixel + 3);
+        }
+    }
+
+    // A zlib stream of stored deflate blocks, the renders are written faster than they would
+    // compress and stay readable by every decoder
+    std::vector<uint8_t> stream = { 0x78, 0x01 };
+    uint32_t adler_a = 1;
+    uint32_t adler_b = 0;
+
+    for (size_t first = 0; first < rows.size() || first == 0; first += 65535)
+    {
+        auto size = (uint16_t)std::min(rows.size() - first, (size_t)65535);
+        auto last = first + size >= rows.size();
+
+        stream.insert(stream.end(), { (uint8_t)last, (uint8_t)size, (uint8_t)(size >> 8), (uint8_t)~size, (uint8_t)(~size >> 8) });
+        stream.insert(stream.end(), rows.begin() + first, rows.begin() + first + size);
+
+        for (size_t i = first; i < first + size; i++)
+        {
+            adler_a = (adler_a + rows[i]) % 65521;
+            adler_b = (adler_b + adler_a) % 65521;
+        }
+
+        if (last)
+        {
+            break;
+        }
+    }
+
+    append_be32(stream, (adler_b << 16) | adler_a);
+    write_png_chunk(file, "IDAT", stream);
+    write_png_chunk(file, "IEND", {});
+
+    return (bool)file;
+}
+
+static bool write_ppm(std::ofstream &file, int width, int height, const std::vector<uint8_t> &pixels)
+{
+    file << "P6\n" << width << " " << height << "\n255\n";
+
+    std::vector<uint8_t> row(width * 3);
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            auto pixel = &pixels[((size_t)y * width + x) * 4];
+
+            row[x * 3] = pixel[0];
+            row[x * 3 + 1] = pixel[1];
+            row[x * 3 + 2] = pixel[2];
+        }
+
+        file.write((const char *)row.data(), row.size());
+    }
+
+    return (bool)file;
+}
+
+bool write_image_file(const std::string &path, int width, int height, const std::vector<uint8_t> &pixels)
+{
+    if (pixels.size() < (size_t)width * height * 4)
+    {
+        return false;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+    if (!file)
+    {
+        return false;
+    }
+
+    if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".ppm") == 0)
+    {
+        return write_ppm(file, width, height, pixels);
+    }
+
+    return write_png(file, width, height, pixels);
+}
+
+ImageWriter::~ImageWriter()
+{
+    stop();
+}
+
+void ImageWriter::start()
+{
+    if (thread.joinable())
+    {
+        return;
+    }
+
+    stopping = false;
+    thread = std::thread(&ImageWriter::worker_loop, this);
+}
+
+void ImageWriter::stop()
+{
+    if (!thread.joinable())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+
+    changed.notify_all();
+    thread.join();
+}
+
+std::vector<uint8_t> ImageWriter::get_buffer()
+{
+    std::lock_guard lock(mutex);
+
+    if (free_buffers.empty())
+    {
+        return {};
+    }
+
+    auto buffer = std::move(free_buffers.back());
+    free_buffers.pop_back();
+
+    return buffer;
+}
+
+void ImageWriter::submit(const std::string &path, int width, int height, std::vector<uint8_t> &&pixels)
+{
+    std::unique_lock lock(mutex);
+
+    changed.wait(lock, [&] { return jobs.size() < IMAGE_WRITER_MAX_QUEUED; });
+    jobs.push_back(Job{path, width, height, std::move(pixels)});
+
+    lock.unlock();
+    changed.notify_all();
+}
+
+size_t ImageWriter::get_failed_count()
+{
+    std::lock_guard lock(mutex);
+    return failed_count;
+}
+
+void ImageWriter::worker_loop()
+{
+    while (true)
+    {
+        std::unique_lock lock(mutex);
+
+        // Queued images are still written after stop was requested
+        changed.wait(lock, [&] { return stopping || !jobs.empty(); });
+
+        if (jobs.empty())
+        {
+            return;
+        }
+
+        auto job = std::move(jobs.front());
+        jobs.pop_front();
+
+        lock.unlock();
+        changed.notify_all();
+
+        auto written = write_image_file(job.path, job.width, job.height, job.pixels);
+
+        lock.lock();
+
+        failed_count += !written;
+        job.pixels.clear();
+        free_buffers.push_back(std::move(job.pixels));
+    }
+}
@@ -0,0 +1,111 @@
+#include <algorithm>
+#include <cstring>
+#include <input_trace.hpp>
+
+bool InputTraceRecorder::open(const std::string &path, float window_width, float window_height, uint64_t circle_count)
+{
+    file.open(path, std::ios::binary | std::ios::trunc);
+
+    if (!file)
+    {
+        return false;
+    }
+
+    InputTraceHeader header = {};
+    std::memcpy(header.magic, INPUT_TRACE_MAGIC, 4);
+    header.version = INPUT_TRACE_VERSION;
+    header.window_width = window_width;
+    header.window_height = window_height;
+    header.circle_count = circle_count;
+
+    file.write((const char *)&header, sizeof(header));
+
+    start_time = std::chrono::steady_clock::now();
+    recorded_microseconds = 0;
+    event_count = 0;
+
+    return (bool)file;
+}
+
+bool InputTraceRecorder::is_open() const
+{
+    return file.is_open();
+}
+
+size_t InputTraceRecorder::get_event_count() const
+{
+    return event_count;
+}
+
+void InputTraceRecorder::add(InputEventType type, uint8_t button, uint8_t action, uint8_t mods, float x, float y)
+{
+    auto elapsed = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+    // Pauses longer than an hour are shortened, they carry no information for a replay
+    auto delta = std::min(elapsed - recorded_microseconds, (uint64_t)UINT32_MAX);
+
+    InputEvent event = { (uint32_t)delta, type, button, action, mods, x, y };
+
+    // The stream buffers the writes, a fast mouse costs no system call per event
+    file.write((const char *)&event, sizeof(event));
+    recorded_microseconds += delta;
+    event_count++;
+}
+
+void InputTraceRecorder::add_cursor_position(double x, double y)
+{
+    add(InputEventType::CursorPosition, 0, 0, 0, (float)x, (float)y);
+}
+
+void InputTraceRecorder::add_mouse_button(int button, int action, int mods)
+{
+    add(InputEventType::MouseButton, (uint8_t)button, (uint8_t)action, (uint8_t)mods, 0.0f, 0.0f);
+}
+
+void InputTraceRecorder::add_scroll(double x_offset, double y_offset)
+{
+    add(InputEventType::Scroll, 0, 0, 0, (float)x_offset, (float)y_offset);
+}
+
+bool InputTraceRecorder::close()
+{
+    if (!file.is_open())
+    {
+        return true;
+    }
+
+    file.flush();
+    auto written = (bool)file;
+    file.close();
+
+    return written;
+}
+
+bool read_input_trace(const std::string &path, InputTraceHeader &header, std::vector<InputEvent> &events)
+{
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+
+    if (!file)
+    {
+        return false;
+    }
+
+    auto size = (size_t)file.tellg();
+
+    if (size < sizeof(header) || (size - sizeof(header)) % sizeof(InputEvent) != 0)
+    {
+        return false;
+    }
+
+    file.seekg(0);
+    file.read((char *)&header, sizeof(header));
+
+    if (!file || std::memcmp(header.magic, INPUT_TRACE_MAGIC, 4) != 0 || header.version != INPUT_TRACE_VERSION)
+    {
+        return false;
+    }
+
+    events.resize((size - sizeof(header)) / sizeof(InputEvent));
+    file.read((char *)events.data(), events.size() * sizeof(InputEvent));
+
+    return (bool)file;
+}
@@ -0,0 +1,74 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <latency_histogram.hpp>
+
+void LatencyHistogram::add(double milliseconds)
+{
+    auto bucket = (int)(std::max(milliseconds, 0.0) / LATENCY_BUCKET_MILLISECONDS);
+
+    buckets[std::min(bucket, LATENCY_BUCKET_COUNT - 1)]++;
+    sample_count++;
+    max_milliseconds = std::max(max_milliseconds, milliseconds);
+    total_milliseconds += milliseconds;
+}
+
+unsigned int LatencyHistogram::get_sample_count() const
+{
+    return sample_count;
+}
+
+double LatencyHistogram::get_percentile(double percentile) const
+{
+    auto target = (unsigned int)std::ceil(sample_count * percentile / 100.0);
+    unsigned int seen = 0;
+
+    for (auto i = 0; i < LATENCY_BUCKET_COUNT; i++)
+    {
+        seen += buckets[i];
+
+        if (seen >= target && seen > 0)
+        {
+            return i == LATENCY_BUCKET_COUNT - 1 ? max_milliseconds : (i + 1) * LATENCY_BUCKET_MILLISECONDS;
+        }
+    }
+
+    return 0.0;
+}
+
+std::string LatencyHistogram::get_report(const std::string &name) const
+{
+    char line[256];
+
+    snprintf(line, sizeof(line), "%s: %u samples, avg %.2f ms, p50 %.1f ms, p90 %.1f ms, p99 %.1f ms, max %.2f ms\n",
+        name.c_str(), sample_count, sample_count > 0 ? total_milliseconds / sample_count : 0.0,
+        get_percentile(50.0), get_percentile(90.0), get_percentile(99.0), max_milliseconds);
+
+    std::string report = line;
+
+    auto largest = *std::max_element(buckets, buckets + LATENCY_BUCKET_COUNT);
+
+    for (auto i = 0; i < LATENCY_BUCKET_COUNT; i++)
+    {
+        if (buckets[i] == 0)
+        {
+            continue;
+        }
+
+        // Bars are scaled to the fullest bucket
+        auto bar = std::string(std::max(1u, buckets[i] * 50 / largest), '#');
+
+        if (i == LATENCY_BUCKET_COUNT - 1)
+        {
+            snprintf(line, sizeof(line), "  >=%5.1f ms %7u %s\n", i * LATENCY_BUCKET_MILLISECONDS, buckets[i], bar.c_str());
+        }
+        else
+        {
+            snprintf(line, sizeof(line), "  <%6.1f ms %7u %s\n", (i + 1) * LATENCY_BUCKET_MILLISECONDS, buckets[i], bar.c_str());
+        }
+
+        report += line;
+    }
+
+    return report;
+}
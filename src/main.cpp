@@ -1,7 +1,16 @@
-#include <fstream>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <batch_render.hpp>
+#include <camera.hpp>
+#include <chain_scene.hpp>
+#include <charconv>
+#include <chrono>
+#include <circle.hpp>
+#include <circle_grid.hpp>
+#include <cstring>
 #include <fmt/core.h>
+#include <fstream>
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/quaternion_trigonometric.hpp>
 #include <glm/geometric.hpp>
@@ -9,586 +18,841 @@
 #include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <gpu_timers.hpp>
+#include <headless_context.hpp>
+#include <input_trace.hpp>
+#include <latency_histogram.hpp>
+#include <offscreen_target.hpp>
+#include <profiler.hpp>
+#include <renderer.hpp>
+#include <scene_file.hpp>
+#include <skin_worker.hpp>
+#include <text_overlay.hpp>
+#include <thread_pool.hpp>
+#include <skinning.hpp>
+#include <thread>
 #include <vector>
 
-#define MAX_CIRCLE_SIZE 150.0f
-#define MIN_CIRCLE_SIZE 5.0f
-#define SKIN_POINT_SIZE 5.0f
-#define LEFT_COLOR glm::vec3(1.0f, 0.0f, 0.0f)
-#define RIGHT_COLOR glm::vec3(0.0f, 0.0f, 1.0f)
-#define BALL_COLOR glm::vec3(0.0f, 1.0f, 0.0f)
-
 float window_width = 800;
 float window_height = 600;
 
+// Cursor in window coordinates and the scene point under it
+glm::vec2 cursor_position = glm::vec2(0.0f);
 glm::vec2 mouse_position = glm::vec2(0.0f);
 
+Camera camera;
+// Dragging with the middle button pans the camera
+bool panning = false;
+
 int holded_circle_index = -1;
 
-struct TouchingCircle
+bool report_curve_vertices = false;
+
+// Set by anything that changes what is on screen, the main loop sleeps while it is false
+bool redraw_requested = true;
+// Input callbacks only record changes, the skin is updated at most once per frame
+bool skin_update_requested = false;
+// Calculate skins on skin_worker instead of the main thread, toggled with B
+bool background_skinning = false;
+
+// All chains back to back, in the order of scene
+std::vector<Circle> circles;
+std::vector<Circle> point_circles;
+// Marker pair in point_circles of every skin point, -1 in chains too short for a skin
+std::vector<int> point_markers;
+// Chains the markers were built for
+std::vector<size_t> marker_chain_starts;
+// Mirrors circles for picking, kept in sync by every edit of the list
+CircleGrid circle_grid;
+
+ChainScene scene;
+// Chain new circles are added to, the last clicked one or a new one started with N
+size_t active_chain = 0;
+// Shared by the scene and skin_worker, only one of them skins at a time
+ThreadPool skin_thread_pool;
+SkinWorker skin_worker;
+std::span<const HermiteCurve> displayed_curves;
+// Skin curves of skin_worker, results only carry the ranges that changed
+std::vector<HermiteCurve> worker_curves;
+// Of the last skin pass, shown in the profiler overlay
+size_t closed_form_fallbacks = 0;
+SceneRenderer renderer;
+
+TextOverlay overlay;
+// Profiler statistics drawn over the scene, toggled with P
+bool show_profiler = false;
+bool profile_csv_open = false;
+
+using LatencyClock = std::chrono::steady_clock;
+
+// Oldest drag event not on screen yet, a default time point when there is none
+LatencyClock::time_point pending_input_time;
+// First skin worker snapshot containing it, results of older snapshots do not show it
+uint32_t pending_input_generation = 0;
+bool pending_input_submitted = false;
+// Drag event shown by the frame being drawn
+LatencyClock::time_point frame_input_time;
+
+GpuTimers gpu_timers;
+LatencyHistogram swap_latency;
+LatencyHistogram gpu_latency;
+// Print the latency histograms on exit, set with --latency-report
+bool report_latency = false;
+
+// Where S saves the scene, the file given with --scene if any
+std::string scene_path = "scene.csk";
+
+// Mouse input of the session, written when --record-trace is given
+InputTraceRecorder input_trace;
+
+void mark_circles_changed()
 {
-    float radius;
-    glm::vec2 position;
-};
+    renderer.mark_circles_dirty();
+    skin_update_requested = true;
+    redraw_requested = true;
+}
 
-struct CircleExternalTangentPoints
+void mark_circle_dirty(int index)
 {
-    glm::vec2 c1_p1;
-    glm::vec2 c2_p1;
-    glm::vec2 c1_p2;
-    glm::vec2 c2_p2;
-};
+    scene.set_circle(index, SkinCircle{circles[index].position, circles[index].radius});
+    circle_grid.update(index, circles[index].position, circles[index].radius);
+    mark_circles_changed();
+}
 
-struct RadicalLine
+void add_circle(const Circle &circle)
 {
-    float a;
-    float b;
-    float c;
-};
+    auto index = scene.append_circle(active_chain, SkinCircle{circle.position, circle.radius});
 
-struct SeparatedPoints
+    circles.insert(circles.begin() + index, circle);
+    circle_grid.insert(index, circle.position, circle.radius);
+    holded_circle_index = index;
+    mark_circles_changed();
+}
+
+void erase_circle(int index)
 {
-    glm::vec2 left_point;
-    glm::vec2 right_point;
-};
+    scene.erase_circle(index);
+    circles.erase(circles.begin() + index);
+    circle_grid.erase(index);
+    mark_circles_changed();
+}
 
-class Circle
+void start_chain()
 {
-public:
-    float radius;
-    glm::vec2 position;
-    std::vector<glm::vec2> vertices;
-    glm::vec3 color;
-    Circle(float r, glm::vec2 pos, glm::vec3 color = BALL_COLOR)
+    // An empty active chain is reused instead of piling up empty ones
+    if (scene.get_chain_circles(active_chain).size() > 0)
     {
-        this->position = pos;
-        this->radius = r;
-        this->color = color;
+        active_chain = scene.add_chain();
+    }
 
-        vertices = std::vector<glm::vec2>();
+    fmt::println("Adding circles to chain {}", active_chain);
+}
 
-        auto alpha = 2 * glm::pi<float>() / 100.0f;
+bool load_scene(const std::string &path)
+{
+    MappedSceneFile scene_file;
 
-        for (int i = 0; i < 100; i++)
-        {
-            vertices.push_back(glm::vec2(0.0f));
-            vertices.push_back(glm::vec2(glm::sin(alpha * (i + 1)), glm::cos(alpha * (i + 1))));
-            vertices.push_back(glm::vec2(glm::sin(alpha * i), glm::cos(alpha * i)));
-        }
-    }
-    std::vector<float> get_vertex_data()
+    if (!scene_file.open(path))
     {
-        std::vector<float> data;
+        return false;
+    }
 
-        for (auto vertex : vertices)
-        {
-            data.push_back(vertex.x);
-            data.push_back(vertex.y);
-            data.push_back(color.x);
-            data.push_back(color.y);
-            data.push_back(color.z);
-        }
+    auto positions = scene_file.get_positions();
+    auto radii = scene_file.get_radii();
 
-        return data;
-    }
-};
+    circles.clear();
+    circle_grid.clear();
 
-class HermiteCurve
-{
-private:
-    glm::vec2 p0;
-    glm::vec2 p1;
-    glm::vec2 v0;
-    glm::vec2 v1;
-    glm::vec3 color;
-    glm::vec2 hermite(glm::vec2 p_cur, glm::vec2 p_next, glm::vec2 v_cur, glm::vec2 v_next, float t)
+    for (size_t i = 0; i < scene_file.get_circle_count(); i++)
     {
-        float h0 = 2 * glm::pow(t, 3) - 3 * glm::pow(t, 2) + 1;
-        float h1 = -2 * glm::pow(t, 3) + 3 * glm::pow(t, 2);
-        float h2 = glm::pow(t, 3) - 2 * glm::pow(t, 2) + t;
-        float h3 = glm::pow(t, 3) - glm::pow(t, 2);
-
-        return h0 * p_cur + h1 * p_next + h2 * v_cur + h3 * v_next;
+        circles.push_back(Circle(radii[i], positions[i]));
+        circle_grid.push_back(positions[i], radii[i]);
     }
-public:
-    HermiteCurve(glm::vec2 p0, glm::vec2 p1, glm::vec2 v0, glm::vec2 v1, glm::vec3 color)
+
+    // Scene files hold a single chain
+    std::vector<SkinCircle> skin_circles;
+    size_t chain_starts[] = { 0, circles.size() };
+
+    for (auto &circle : circles)
     {
-        this->p0 = p0;
-        this->p1 = p1;
-        this->v0 = v0;
-        this->v1 = v1;
-        this->color = color;
+        skin_circles.push_back(SkinCircle{circle.position, circle.radius});
     }
-    std::vector<float> get_vertex_data(int segments)
-    {
-        std::vector<float> data;
-
-        for (int i = 0; i <= segments; i++)
-        {
-            float t0 = (float)i / (float)segments;
 
-            auto point = hermite(p0, p1, v0, v1, t0);
+    scene.assign(skin_circles, chain_starts);
+    active_chain = 0;
+    holded_circle_index = -1;
+    mark_circles_changed();
 
-            data.push_back(point.x);
-            data.push_back(point.y);
-            data.push_back(color.x);
-            data.push_back(color.y);
-            data.push_back(color.z);
-        }
+    return true;
+}
 
-        return data;
+void save_scene(const std::string &path)
+{
+    if (scene.get_chain_count() > 1)
+    {
+        fmt::println("Scene files hold a single chain, the {} chains are saved joined", scene.get_chain_count());
     }
-};
 
-std::vector<Circle> circles;
-std::vector<Circle> point_circles;
-std::vector<HermiteCurve> curves;
+    if (write_scene_file(path, scene.get_circles()))
+    {
+        fmt::println("Saved {} circles to {}", scene.get_circle_count(), path);
+    }
+    else
+    {
+        fmt::println("Failed to save the scene to {}", path);
+    }
+}
 
-// Based on: https://math.stackexchange.com/questions/3100828/calculate-the-circle-that-touches-three-other-circles
-TouchingCircle * find_touching_circle(Circle *c1, Circle *c2, Circle *c3, int s1, int s2, int s3)
+void initialize_scene(bool load_scene_file)
 {
-    float r1 = s1 * c1->radius;
-    float r2 = s2 * c2->radius;
-    float r3 = s3 * c3->radius;
-
-    float x1 = c1->position.x;
-    float y1 = c1->position.y;
-    float x2 = c2->position.x;
-    float y2 = c2->position.y;
-    float x3 = c3->position.x;
-    float y3 = c3->position.y;
-
-    float k_a = -glm::pow(r1, 2) + glm::pow(r2, 2) + glm::pow(x1, 2) - glm::pow(x2, 2) + glm::pow(y1, 2) - glm::pow(y2, 2);
-    float k_b = -glm::pow(r1, 2) + glm::pow(r3, 2) + glm::pow(x1, 2) - glm::pow(x3, 2) + glm::pow(y1, 2) - glm::pow(y3, 2);
+    circles = std::vector<Circle>();
+    point_circles = std::vector<Circle>();
+    scene.thread_pool = &skin_thread_pool;
+    active_chain = scene.add_chain();
 
-    float d = x1 * (y2 - y3) + x2 * (y3 - y1) + x3 * (y1 - y2);
-    float a0 = (k_a * (y1 - y3) + k_b * (y2 - y1)) / (2 * d);
-    float b0 = -(k_a * (x1 - x3) + k_b * (x2 - x1)) / (2 * d);
+    if (load_scene_file && !load_scene(scene_path))
+    {
+        fmt::println("Failed to load scene {}, convert text scenes with --import first", scene_path);
+    }
+}
 
-    float a1 = -(r1 * (y2 - y3) + r2 * (y3 - y1) + r3 * (y1 - y2)) / d;
-    float b1 = (r1 * (x2 - x3) + r2 * (x3 - x1) + r3 * (x1 - x2)) / d;
+// Runs --import and --skin, which work on files only and never open a window
+int run_file_command(const std::string &command, const std::string &input_path, const std::string &output_path, size_t chunk_circles, bool mixed_precision)
+{
+    if (command == "--import")
+    {
+        if (!import_text_scene(input_path, output_path))
+        {
+            fmt::println("Failed to import {} into {}", input_path, output_path);
+            return 1;
+        }
 
-    // float C0 = glm::pow(a0 - x1, 2) + glm::pow(b0 - y1, 2) - glm::pow(r1, 2);
-    float C0 = glm::pow(a0, 2) - 2 * a0 * x1 + glm::pow(b0, 2) - 2 * b0 * y1 - glm::pow(r1, 2) + glm::pow(x1, 2) + glm::pow(y1, 2);
-    // float C1 = a1 * (a0 - x1) + b1 * (b0 - y1) - r1;
-    float C1 = a0 * a1 - a1 * x1 + b0 * b1 - b1 * y1 - r1;
-    float C2 = glm::pow(a1, 2) + glm::pow(b1, 2) - 1;
+        return 0;
+    }
 
-    auto root_inner = glm::pow(C1, 2) - C0 * C2;
+    MappedSceneFile scene;
 
-    if (root_inner < 0)
+    if (!scene.open(input_path))
     {
-        return nullptr;
+        fmt::println("Failed to open scene {}", input_path);
+        return 1;
     }
 
-    float r = (-glm::sqrt(glm::pow(C1, 2) - C0 * C2) - C1)/ C2;
+    if (!skin_scene_file(scene, output_path, chunk_circles, mixed_precision))
+    {
+        fmt::println("Failed to skin {} into {}, a scene needs at least two circles", input_path, output_path);
+        return 1;
+    }
 
-    float x = a0 + a1 * r;
-    float y = b0 + b1 * r;
+    fmt::println("Skinned {} circles into {}", scene.get_circle_count(), output_path);
+    return 0;
+}
 
-    return new TouchingCircle{r, glm::vec2(x, y)};
+void set_point_markers(size_t index, glm::vec2 left_point, glm::vec2 right_point)
+{
+    if (point_markers[index] >= 0)
+    {
+        point_circles[2 * point_markers[index]].position = left_point;
+        point_circles[2 * point_markers[index] + 1].position = right_point;
+    }
 }
 
-CircleExternalTangentPoints * get_tangent_points(glm::vec2 c1_pos, float r1, glm::vec2 c2_pos, float r2)
+// Markers of the skin points. Chains of fewer than two circles have no skin and no markers, so
+// the markers are rebuilt whenever the chains change.
+void update_point_circles(std::span<const glm::vec2> left_points, std::span<const glm::vec2> right_points, std::span<const size_t> chain_starts, size_t first, size_t last)
 {
-    auto d = c2_pos - c1_pos;
-    auto l = glm::length(d);
-    auto u = d / l;
-    auto v = glm::vec2(-d.y / l, d.x / l);
+    if (!std::equal(chain_starts.begin(), chain_starts.end(), marker_chain_starts.begin(), marker_chain_starts.end()))
+    {
+        point_circles.clear();
+        point_markers.assign(left_points.size(), -1);
+        marker_chain_starts.assign(chain_starts.begin(), chain_starts.end());
 
-    auto p1 = c1_pos + r1 * ((r2 - r1) * u + l * v) / l;
-    auto p2 = c2_pos + r2 * ((r2 - r1) * u + l * v) / l;
-    auto p3 = c1_pos + r1 * ((r2 - r1) * u + l * -1 * v) / l;
-    auto p4 = c2_pos + r2 * ((r2 - r1) * u + l * -1 * v) / l;
+        for (size_t chain = 0; chain + 1 < chain_starts.size(); chain++)
+        {
+            if (chain_starts[chain + 1] - chain_starts[chain] < 2)
+            {
+                continue;
+            }
 
-    return new CircleExternalTangentPoints{p1, p2, p3, p4};
-}
+            for (auto i = chain_starts[chain]; i < chain_starts[chain + 1]; i++)
+            {
+                point_markers[i] = point_circles.size() / 2;
+                point_circles.push_back(Circle(SKIN_POINT_SIZE, left_points[i], LEFT_COLOR));
+                point_circles.push_back(Circle(SKIN_POINT_SIZE, right_points[i], RIGHT_COLOR));
+            }
+        }
 
-bool get_if_circles_touch_externally_or_internally(glm::vec2 common_circle_pos, float common_circle_radius, glm::vec2 circle_pos, float circle_radius)
-{
-    auto distance = glm::distance(circle_pos, common_circle_pos);
-    auto radius_diff = glm::abs(circle_radius - common_circle_radius);
+        return;
+    }
 
-    if (glm::abs(distance - radius_diff) < 0.1f)
+    for (auto i = first; i <= last && i < left_points.size(); i++)
     {
-        // Circles touch internally
-        return true;
+        set_point_markers(i, left_points[i], right_points[i]);
     }
-
-    // Circles touch externally (no need for further checks, since the circles are guaranteed to touch)
-    return false;
 }
 
-std::tuple<glm::vec2, glm::vec2> find_curve_points_for_circle(int index)
+void calculate_skin()
 {
-    int s2_counter = 0;
-    int s3_counter = 0;
+    if (scene.update_skins() == 0)
+    {
+        return;
+    }
 
-    int s1 = 1;
-    int s2 = 1;
-    int s3 = 1;
+    auto &skin = scene.get_skin();
+    auto chain_starts = scene.get_chain_starts();
 
-    std::vector<glm::vec2> curve_points;
+    displayed_curves = skin.curves;
+    closed_form_fallbacks = scene.get_closed_form_fallbacks();
+    renderer.mark_skin_dirty();
 
-    for (auto i = 0; i < 8; i++)
+    for (auto chain : scene.get_updated_chains())
     {
-        auto touching_circle = find_touching_circle(&circles[index - 1], &circles[index], &circles[index + 1], s1, s2, s3);
+        auto window = scene.get_updated_window(chain);
 
-        if (touching_circle == nullptr)
+        if (window.first_point <= window.last_point)
         {
-            auto tangent_points = get_tangent_points(
-                circles[index].position, circles[index].radius,
-                circles[index + 1].position, circles[index + 1].radius);
-
-            auto result = std::make_tuple(tangent_points->c1_p1, tangent_points->c1_p2);
+            update_point_circles(skin.left_points, skin.right_points, chain_starts, chain_starts[chain] + window.first_point, chain_starts[chain] + window.last_point);
+        }
+    }
+}
 
-            delete tangent_points;
+void apply_skin_result(const SkinResult &result)
+{
+    // The main thread may already have moved on, the circles are drawn from the live state anyway
+    if (result.full)
+    {
+        update_point_circles(result.skin.left_points, result.skin.right_points, result.chain_starts, 0, SIZE_MAX);
+        worker_curves.assign(result.skin.curves.begin(), result.skin.curves.end());
+    }
+    else
+    {
+        size_t offset = 0;
 
-            return result;
+        for (auto &range : result.point_ranges)
+        {
+            for (auto i = range.first; i <= range.last; i++, offset++)
+            {
+                set_point_markers(i, result.skin.left_points[offset], result.skin.right_points[offset]);
+            }
         }
 
-        auto touching_point = touching_circle->position + glm::normalize(circles[index].position - touching_circle->position) * touching_circle->radius;
+        offset = 0;
+
+        for (auto &range : result.curve_ranges)
+        {
+            std::copy(result.skin.curves.begin() + offset, result.skin.curves.begin() + offset + (range.last - range.first + 1), worker_curves.begin() + range.first);
+            offset += range.last - range.first + 1;
+        }
+    }
 
-        auto control_orientation = get_if_circles_touch_externally_or_internally(touching_circle->position, touching_circle->radius, circles[index].position, circles[index].radius);
+    displayed_curves = worker_curves;
+    closed_form_fallbacks = result.closed_form_fallbacks;
+    renderer.mark_skin_dirty();
+    redraw_requested = true;
+}
 
-        auto all_same_orientation = true;
+void wake_event_loop()
+{
+    glfwPostEmptyEvent();
+}
 
-        for (auto circle : { &circles[index - 1], &circles[index + 1] })
+void update_skin()
+{
+    if (background_skinning)
+    {
+        if (skin_update_requested)
         {
-            auto orientation = get_if_circles_touch_externally_or_internally(touching_circle->position, touching_circle->radius, circle->position, circle->radius);
+            auto generation = skin_worker.submit(scene.get_circles(), scene.get_chain_starts());
+            skin_update_requested = false;
 
-            if (orientation != control_orientation)
+            if (pending_input_time != LatencyClock::time_point() && !pending_input_submitted)
             {
-                all_same_orientation = false;
-                break;
+                pending_input_generation = generation;
+                pending_input_submitted = true;
             }
         }
 
-        if (all_same_orientation)
+        if (auto result = skin_worker.acquire_result())
         {
-            curve_points.push_back(touching_point);
+            apply_skin_result(*result);
+
+            if (pending_input_submitted && (int32_t)(result->generation - pending_input_generation) >= 0)
+            {
+                frame_input_time = pending_input_time;
+                pending_input_time = LatencyClock::time_point();
+                pending_input_submitted = false;
+            }
         }
 
-        s2_counter++;
-        s3_counter++;
+        return;
+    }
 
-        s1 *= -1;
+    if (skin_update_requested)
+    {
+        calculate_skin();
+        skin_update_requested = false;
+    }
+
+    frame_input_time = pending_input_time;
+    pending_input_time = LatencyClock::time_point();
+    pending_input_submitted = false;
+}
 
-        if (s2_counter % 2 == 0)
+void record_gpu_times()
+{
+    GpuFrameTimes times;
+
+    while (gpu_timers.poll(times))
+    {
+        if (get_profiler().is_enabled())
         {
-            s2 *= -1;
+            get_profiler().add(ProfileStage::GpuCircles, (uint64_t)(times.stage_milliseconds[(int)GpuStage::Circles] * 1e6));
+            get_profiler().add(ProfileStage::GpuCurves, (uint64_t)(times.stage_milliseconds[(int)GpuStage::Curves] * 1e6));
         }
 
-        if (s3_counter % 4 == 0)
+        if (times.tag != LatencyClock::time_point())
         {
-            s3 *= -1;
+            gpu_latency.add(std::chrono::duration<double, std::milli>(times.finished - times.tag).count());
         }
-
-        delete touching_circle;
     }
-
-    return std::make_tuple(curve_points[0], curve_points[1]);
 }
 
-RadicalLine * get_radical_line(glm::vec2 c1_pos, float r1, glm::vec2 c2_pos, float r2)
+void set_background_skinning(bool enabled)
 {
-    float a = 2 * (c2_pos.x - c1_pos.x);
-    float b = 2 * (c2_pos.y - c1_pos.y);
-    // float c = (glm::pow(c1_pos.x, 2) + glm::pow(c2_pos.x, 2)) - (glm::pow(c1_pos.y, 2) + glm::pow(c2_pos.y, 2)) - (glm::pow(r1, 2) + glm::pow(r2, 2));
-    float c = (glm::pow(c1_pos.x, 2) - glm::pow(c2_pos.x, 2)) + (glm::pow(c1_pos.y, 2) - glm::pow(c2_pos.y, 2)) - (glm::pow(r1, 2) + glm::pow(r2, 2));
+    background_skinning = enabled;
 
-    return new RadicalLine{a, b, c};
+    if (enabled)
+    {
+        skin_worker.result_callback = wake_event_loop;
+        skin_worker.thread_pool = &skin_thread_pool;
+        skin_worker.start();
+    }
+    else
+    {
+        skin_worker.stop();
+        // The markers and curves on screen are the worker's, the local skin replaces all of them
+        scene.mark_all_dirty();
+    }
+
+    skin_update_requested = true;
+    fmt::println("Skinning on {}", enabled ? "a background thread" : "the main thread");
 }
 
-glm::vec2 find_radical_center(glm::vec2 c1_pos, float r1, glm::vec2 c2_pos, float r2, glm::vec2 c3_pos, float r3)
+void set_profiler_visible(bool visible)
 {
-    float x1 = c1_pos.x;
-    float y1 = c1_pos.y;
-    float x2 = c2_pos.x;
-    float y2 = c2_pos.y;
-    float x3 = c3_pos.x;
-    float y3 = c3_pos.y;
+    if (visible && !overlay.is_initialized())
+    {
+        auto font = find_overlay_font();
 
-    auto radical_line1 = get_radical_line(c1_pos, r1, c2_pos, r2);
-    auto radical_line2 = get_radical_line(c2_pos, r1, c3_pos, r3);
+        if (font.empty() || !overlay.initialize(font, 14))
+        {
+            fmt::println("Failed to load a font for the profiler overlay");
+            return;
+        }
+    }
 
-    float a1 = radical_line1->a;
-    float b1 = radical_line1->b;
-    float c1 = radical_line1->c * -1;
+    show_profiler = visible;
+    get_profiler().set_enabled(show_profiler || profile_csv_open);
+    redraw_requested = true;
+}
 
-    float a2 = radical_line2->a;
-    float b2 = radical_line2->b;
-    float c2 = radical_line2->c * -1;
+std::string get_profiler_text()
+{
+    auto &profiler = get_profiler();
+
+    auto text = fmt::format("{:<18}{:>10}{:>10}{:>10}\n", "stage (us)", "min", "avg", "p99");
 
-    float d = a1 * b2 - a2 * b1;
+    for (auto stage = 0; stage < PROFILE_STAGE_COUNT; stage++)
+    {
+        auto stats = profiler.get_stats((ProfileStage)stage);
 
-    float x = (c1 * b2 - c2 * b1) / d;
-    float y = (a1 * c2 - a2 * c1) / d;
+        text += fmt::format("{:<18}{:>10.1f}{:>10.1f}{:>10.1f}\n", get_profile_stage_name((ProfileStage)stage), stats.min_microseconds, stats.average_microseconds, stats.p99_microseconds);
+    }
 
-    delete radical_line1;
-    delete radical_line2;
+    text += fmt::format("{:<18}{:>10}\n", "search fallbacks", closed_form_fallbacks);
+    text += fmt::format("{:<18}{:>10}\n", "drawn circles", renderer.get_drawn_circle_count());
+    text += fmt::format("{:<18}{:>10}\n", "drawn curves", renderer.get_drawn_curve_count());
 
-    return glm::vec2(x, y);
+    return text;
 }
 
-glm::vec2 rotate_vector(glm::vec2 vec, float angle)
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
 {
-    float rad = glm::radians(angle);
-
-    float cos = glm::cos(rad);
-    float sin = glm::sin(rad);
+    window_width = width;
+    window_height = height;
+    glViewport(0, 0, width, height);
+    redraw_requested = true;
+}
 
-    return glm::mat2x2(cos, -sin, sin, cos) * vec;
+void window_refresh_callback(GLFWwindow* window)
+{
+    redraw_requested = true;
 }
 
-glm::vec2 flip_when_facing_opposite(glm::vec2 vec, glm::vec2 check_against)
+void cursor_position_callback(GLFWwindow* window, double xpos, double ypos)
 {
-    float dot = vec.x * check_against.x + vec.y * check_against.y;
-    float det = vec.x * check_against.y - vec.y * check_against.x;
+    if (input_trace.is_open())
+    {
+        input_trace.add_cursor_position(xpos, ypos);
+    }
 
-    float angle = glm::atan(det, dot);
+    auto new_cursor_position = glm::vec2(xpos, ypos);
 
-    if (glm::abs(angle) > glm::radians(90.0f))
+    if (panning)
     {
-        return -vec;
+        camera.pan(new_cursor_position - cursor_position);
+        redraw_requested = true;
     }
 
-    return vec;
+    cursor_position = new_cursor_position;
+    mouse_position = camera.window_to_scene(cursor_position);
+
+    if (holded_circle_index != -1)
+    {
+        circles[holded_circle_index].position = mouse_position;
+
+        if (pending_input_time == LatencyClock::time_point())
+        {
+            pending_input_time = LatencyClock::now();
+        }
+
+        mark_circle_dirty(holded_circle_index);
+    }
 }
 
-std::tuple<glm::vec2, glm::vec2> calculate_tangents(glm::vec2 c1_pos, float r1, glm::vec2 c2_pos, float r2, glm::vec2 point1, glm::vec2 point2)
+void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
 {
-    auto radical_line = get_radical_line(c1_pos, r1, c2_pos, r2);
+    if (input_trace.is_open())
+    {
+        input_trace.add_mouse_button(button, action, mods);
+    }
 
-    float radical_distance_a = (glm::abs(radical_line->a * point1.x + radical_line->b * point1.y + radical_line->c)) / glm::sqrt(glm::pow(radical_line->a, 2) + glm::pow(radical_line->b, 2));
-    float radical_distance_b = (glm::abs(radical_line->a * point2.x + radical_line->b * point2.y + radical_line->c)) / glm::sqrt(glm::pow(radical_line->a, 2) + glm::pow(radical_line->b, 2));
+    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+    {
+        holded_circle_index = circle_grid.find_first(mouse_position);
 
-    auto p1_to_c1_vec = (c1_pos - point1) / glm::length(c1_pos - point1);
-    auto p2_to_c2_vec = (c2_pos - point2) / glm::length(c2_pos - point2);
+        if (holded_circle_index == -1)
+        {
+            add_circle(Circle(50.0f, mouse_position));
+        }
+        else
+        {
+            active_chain = scene.get_chain_of(holded_circle_index);
+        }
+        return;
+    }
 
-    delete radical_line;
+    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE)
+    {
+        holded_circle_index = -1;
+        return;
+    }
 
-    auto p1_to_p2_vec = point2 - point1;
+    if (button == GLFW_MOUSE_BUTTON_MIDDLE)
+    {
+        panning = action == GLFW_PRESS;
+        return;
+    }
 
-    auto tangent1 = flip_when_facing_opposite(rotate_vector(p1_to_c1_vec, -90.0f) * 2.0f * radical_distance_a, p1_to_p2_vec);
-    auto tangent2 = flip_when_facing_opposite(rotate_vector(p2_to_c2_vec, -90.0f) * 2.0f * radical_distance_b, p1_to_p2_vec);
+    if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS)
+    {
+        auto index = circle_grid.find_first(mouse_position);
 
-    return std::make_tuple(tangent1, tangent2);
+        if (index != -1)
+        {
+            erase_circle(index);
+        }
+        return;
+    }
 }
 
-SeparatedPoints * separate_points(glm::vec2 point1, glm::vec2 point2, int index)
+void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
 {
-    auto radical_center = find_radical_center(
-        circles[index].position, circles[index].radius,
-        circles[index - 1].position, circles[index - 1].radius,
-        circles[index + 1].position, circles[index + 1].radius);
-
-    glm::vec2 to_check = circles[index].position - circles[index - 1].position;
-    glm::vec2 check_against = circles[index + 1].position - circles[index - 1].position;
-
-    float dot = to_check.x * check_against.x + to_check.y * check_against.y;
-    float det = to_check.x * check_against.y - to_check.y * check_against.x;
-
-    float angle = glm::atan(det, dot);
-
-    auto p1_radical_distance = glm::distance(radical_center, point1);
-    auto p2_radical_distance = glm::distance(radical_center, point2);
-
-    glm::vec2 left;
-    glm::vec2 right;
+    if (input_trace.is_open())
+    {
+        input_trace.add_scroll(xoffset, yoffset);
+    }
 
-    if (angle < 0)
+    if (holded_circle_index != -1)
     {
-        if (p1_radical_distance < p2_radical_distance)
+        circles[holded_circle_index].radius += yoffset;
+
+        if (circles[holded_circle_index].radius < MIN_CIRCLE_SIZE)
         {
-            left = (point1);
-            right = (point2);
+            circles[holded_circle_index].radius = MIN_CIRCLE_SIZE;
         }
-        else
-    {
-            left = (point2);
-            right = (point1);
+        else if (circles[holded_circle_index].radius > MAX_CIRCLE_SIZE)
+        {
+            circles[holded_circle_index].radius = MAX_CIRCLE_SIZE;
         }
+
+        mark_circle_dirty(holded_circle_index);
     }
     else
     {
-        if (p1_radical_distance < p2_radical_distance)
+        camera.zoom_at(cursor_position, glm::pow(CAMERA_ZOOM_STEP, (float)yoffset));
+        mouse_position = camera.window_to_scene(cursor_position);
+        redraw_requested = true;
+    }
+}
+
+void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    if (key == GLFW_KEY_T && action == GLFW_PRESS)
+    {
+        if (renderer.get_curve_render_mode() == CurveRenderMode::Tessellation)
         {
-            left = (point2);
-            right = (point1);
+            renderer.set_curve_render_mode(CurveRenderMode::Cpu);
         }
         else
         {
-            left = (point1);
-            right = (point2);
+            renderer.set_curve_render_mode(CurveRenderMode::Tessellation);
         }
+
+        redraw_requested = true;
     }
 
-    return new SeparatedPoints{left, right };
+    if (key == GLFW_KEY_A && action == GLFW_PRESS)
+    {
+        renderer.curve_segments = renderer.curve_segments == 0 ? 30 : 0;
+        report_curve_vertices = true;
+        redraw_requested = true;
+    }
+
+    if (key == GLFW_KEY_B && action == GLFW_PRESS)
+    {
+        set_background_skinning(!background_skinning);
+    }
+
+    if (key == GLFW_KEY_P && action == GLFW_PRESS)
+    {
+        set_profiler_visible(!show_profiler);
+    }
+
+    if (key == GLFW_KEY_S && action == GLFW_PRESS)
+    {
+        save_scene(scene_path);
+    }
+
+    if (key == GLFW_KEY_N && action == GLFW_PRESS)
+    {
+        start_chain();
+    }
+
+    if (key == GLFW_KEY_HOME && action == GLFW_PRESS)
+    {
+        camera = Camera();
+        mouse_position = camera.window_to_scene(cursor_position);
+        redraw_requested = true;
+    }
 }
 
-void calculate_skin()
+// Everything on screen, drawn into the window or the framebuffer of a replay
+void draw_scene()
 {
-    if (circles.size() < 2)
+    glClear(GL_COLOR_BUFFER_BIT);
+
+    auto projection = camera.get_projection(window_width, window_height);
+    auto window_projection = glm::ortho(0.0f, window_width, window_height, 0.0f, -1.0f, 1.0f);
+
+    // Geometry stays in GPU buffers between frames, only what was marked dirty is uploaded
+    renderer.render(projection, circles, point_circles, displayed_curves);
+
+    if (report_curve_vertices)
     {
-        return;
+        fmt::println("Curve tessellation: {}, {} vertices", renderer.curve_segments == 0 ? "adaptive" : "fixed", renderer.get_curve_vertex_count());
+        report_curve_vertices = false;
     }
 
-    curves.clear();
-    point_circles.clear();
+    if (show_profiler)
+    {
+        overlay.draw(window_projection, get_profiler_text(), glm::vec2(10.0f, 10.0f), glm::vec3(0.0f));
+    }
+}
 
-    std::vector<glm::vec2> left_points;
-    std::vector<glm::vec2> right_points;
+void dispatch_input_event(const InputEvent &event)
+{
+    switch (event.type)
+    {
+    case InputEventType::CursorPosition:
+        cursor_position_callback(nullptr, event.x, event.y);
+        break;
+    case InputEventType::MouseButton:
+        mouse_button_callback(nullptr, event.button, event.action, event.mods);
+        break;
+    case InputEventType::Scroll:
+        scroll_callback(nullptr, event.x, event.y);
+        break;
+    }
+}
 
-    auto first_points = get_tangent_points(
-        circles[0].position, circles[0].radius,
-        circles[1].position, circles[1].radius);
+// Feeds a recorded trace through the input callbacks and draws into a framebuffer of the
+// recorded size, no window is opened. A fast replay draws after every event. A realtime replay
+// waits for the recorded times and draws once for all events due by then, like the event loop.
+// Frames end with glFinish, so frame times include the GPU. Returns the exit code.
+int replay_input_trace(const std::string &path, bool realtime, const std::string &csv_path, bool load_scene_file)
+{
+    InputTraceHeader header;
+    std::vector<InputEvent> events;
 
-    auto separate_points_first = separate_points(first_points->c1_p1, first_points->c1_p2, 0);
-    left_points.push_back(separate_points_first->left_point);
-    point_circles.push_back(Circle(SKIN_POINT_SIZE, separate_points_first->left_point, LEFT_COLOR));
-    right_points.push_back(separate_points_first->right_point);
-    point_circles.push_back(Circle(SKIN_POINT_SIZE, separate_points_first->right_point, RIGHT_COLOR));
+    if (!read_input_trace(path, header, events))
+    {
+        fmt::println("Failed to read input trace {}", path);
+        return 1;
+    }
 
-    delete first_points;
-    delete separate_points_first;
+    std::ofstream csv;
 
-    for (auto i = 1; i < circles.size() - 1; i++)
+    if (!csv_path.empty())
     {
-        auto points = find_curve_points_for_circle(i);
+        csv.open(csv_path, std::ios::trunc);
 
-        auto separated_points = separate_points(std::get<0>(points), std::get<1>(points), i);
+        if (!csv)
+        {
+            fmt::println("Failed to open {}", csv_path);
+            return 1;
+        }
+
+        csv << "event,type,time_ms,skin_ms,frame_ms,latency_ms\n";
+    }
 
-        left_points.push_back(separated_points->left_point);
-        point_circles.push_back(Circle(SKIN_POINT_SIZE, separated_points->left_point, LEFT_COLOR));
-        right_points.push_back(separated_points->right_point);
-        point_circles.push_back(Circle(SKIN_POINT_SIZE, separated_points->right_point, RIGHT_COLOR));
+    HeadlessContext context;
 
-        delete separated_points;
+    if (!context.initialize())
+    {
+        fmt::println("Failed to create a headless GL 4.1 context");
+        return 1;
     }
 
-    auto last_points = get_tangent_points(
-        circles[circles.size() - 2].position, circles[circles.size() - 2].radius,
-        circles[circles.size() - 1].position, circles[circles.size() - 1].radius);
-    auto separate_points_last = separate_points(last_points->c2_p1, last_points->c2_p2, circles.size() - 2);
-    left_points.push_back(separate_points_last->left_point);
-    point_circles.push_back(Circle(SKIN_POINT_SIZE, separate_points_last->left_point, LEFT_COLOR));
-    right_points.push_back(separate_points_last->right_point);
-    point_circles.push_back(Circle(SKIN_POINT_SIZE, separate_points_last->right_point, RIGHT_COLOR));
+    window_width = header.window_width;
+    window_height = header.window_height;
 
-    delete last_points;
-    delete separate_points_last;
+    OffscreenTarget target;
 
-    for (auto i = 0; i < left_points.size() - 1; i++)
+    if (!renderer.initialize())
     {
-        auto tanggents = calculate_tangents(
-            circles[i].position, circles[i].radius,
-            circles[i + 1].position, circles[i + 1].radius,
-            left_points[i], left_points[i + 1]);
-
-        curves.push_back(HermiteCurve(
-            left_points[i], left_points[i + 1],
-            std::get<0>(tanggents), std::get<1>(tanggents),
-            LEFT_COLOR));
+        fmt::println("Failed to create shader programs");
+        return 1;
     }
 
-    for (auto i = 0; i < right_points.size() - 1; i++)
+    if (!target.initialize((int)window_width, (int)window_height))
     {
-        auto tanggents = calculate_tangents(
-            circles[i].position, circles[i].radius,
-            circles[i + 1].position, circles[i + 1].radius,
-            right_points[i], right_points[i + 1]);
-
-        curves.push_back(HermiteCurve(
-            right_points[i], right_points[i + 1],
-            std::get<0>(tanggents), std::get<1>(tanggents),
-            RIGHT_COLOR));
+        fmt::println("Failed to create a {}x{} framebuffer", window_width, window_height);
+        renderer.destroy();
+        return 1;
     }
-}
 
-void framebuffer_size_callback(GLFWwindow* window, int width, int height)
-{
-    window_width = width;
-    window_height = height;
-    glViewport(0, 0, width, height);
-}
+    target.bind();
+    glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 
-void cursor_position_callback(GLFWwindow* window, double xpos, double ypos)
-{
-    mouse_position = glm::vec2(xpos, ypos);
+    initialize_scene(load_scene_file);
 
-    if (holded_circle_index != -1)
+    if (scene.get_circle_count() != header.circle_count)
     {
-        circles[holded_circle_index].position = mouse_position;
+        fmt::println("The trace was recorded on a scene of {} circles, replaying it on {}", header.circle_count, scene.get_circle_count());
+    }
 
-        calculate_skin();
+    // Recorded time of every event since the start of the trace
+    std::vector<uint64_t> event_microseconds(events.size());
+    uint64_t elapsed = 0;
+
+    for (size_t i = 0; i < events.size(); i++)
+    {
+        elapsed += events[i].delta_microseconds;
+        event_microseconds[i] = elapsed;
     }
-}
 
-void mouse_button_callback(GLFWwindow* window, int button, int action, int mods)
-{
-    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+    LatencyHistogram skin_times;
+    LatencyHistogram frame_times;
+    LatencyHistogram input_latency;
+    size_t frame_count = 0;
+    size_t next = 0;
+
+    auto start_time = LatencyClock::now();
+    auto get_due_time = [&](size_t event)
     {
-        for (auto i = 0; i < circles.size(); i++)
+        return start_time + std::chrono::microseconds(event_microseconds[event]);
+    };
+
+    while (next < events.size())
+    {
+        if (realtime)
         {
-            auto circle = circles[i];
+            std::this_thread::sleep_until(get_due_time(next));
+        }
 
-            if (glm::distance(mouse_position, circle.position) <= circle.radius)
-            {
-                holded_circle_index = i;
-                break;
-            }
+        auto first = next;
+        auto handled_time = LatencyClock::now();
+
+        do
+        {
+            dispatch_input_event(events[next]);
+            next++;
         }
+        while (realtime && next < events.size() && get_due_time(next) <= LatencyClock::now());
 
-        if (holded_circle_index == -1)
+        ScopedTimer frame_timer(ProfileStage::Frame);
+
+        auto skin_start = LatencyClock::now();
+        update_skin();
+        auto skin_end = LatencyClock::now();
+
+        // Events that changed nothing on screen do not draw, the same as in the window
+        auto drawn = redraw_requested;
+
+        if (redraw_requested)
         {
-            circles.push_back(Circle(50.0f, mouse_position));
-            holded_circle_index = circles.size() - 1;
-            calculate_skin();
+            redraw_requested = false;
+            draw_scene();
+            glFinish();
+            frame_count++;
         }
-        return;
-    }
 
-    if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_RELEASE)
-    {
-        holded_circle_index = -1;
-        return;
-    }
+        auto frame_end = LatencyClock::now();
+        frame_timer.stop();
 
-    if (button == GLFW_MOUSE_BUTTON_RIGHT && action == GLFW_PRESS)
-    {
-        for (auto i = 0; i < circles.size(); i++)
+        if (drawn && get_profiler().is_enabled())
+        {
+            get_profiler().end_frame();
+        }
+
+        auto skin_milliseconds = std::chrono::duration<double, std::milli>(skin_end - skin_start).count();
+        auto frame_milliseconds = drawn ? std::chrono::duration<double, std::milli>(frame_end - skin_end).count() : 0.0;
+
+        for (auto i = first; i < next; i++)
         {
-            auto circle = circles[i];
+            // A fast replay handles every event as soon as the last frame is done
+            auto input_time = realtime ? get_due_time(i) : handled_time;
+            auto latency_milliseconds = std::chrono::duration<double, std::milli>(frame_end - input_time).count();
+
+            skin_times.add(skin_milliseconds);
 
-            if (glm::distance(mouse_position, circle.position) <= circle.radius)
+            if (drawn)
             {
-                circles.erase(circles.begin() + i);
-                calculate_skin();
-                break;
+                frame_times.add(frame_milliseconds);
+                input_latency.add(latency_milliseconds);
+            }
+
+            if (csv.is_open())
+            {
+                csv << fmt::format("{},{},{:.3f},{:.3f},{:.3f},{:.3f}\n", i, (int)events[i].type, event_microseconds[i] / 1000.0, skin_milliseconds, frame_milliseconds, drawn ? latency_milliseconds : 0.0);
             }
         }
-        return;
     }
-}
 
-void scroll_callback(GLFWwindow* window, double xoffset, double yoffset)
-{
-    if (holded_circle_index != -1)
-    {
-        circles[holded_circle_index].radius += yoffset;
+    auto seconds = std::chrono::duration<double>(LatencyClock::now() - start_time).count();
 
-        if (circles[holded_circle_index].radius < MIN_CIRCLE_SIZE)
-        {
-            circles[holded_circle_index].radius = MIN_CIRCLE_SIZE;
-        }
-        else if (circles[holded_circle_index].radius > MAX_CIRCLE_SIZE)
-        {
-            circles[holded_circle_index].radius = MAX_CIRCLE_SIZE;
-        }
+    fmt::println("Replayed {} events in {:.2f} s, recorded in {:.2f} s, {} frames drawn", events.size(), seconds, elapsed / 1e6, frame_count);
+    fmt::print("{}", skin_times.get_report("Skin update"));
+    fmt::print("{}", frame_times.get_report("Frame"));
+    fmt::print("{}", input_latency.get_report("Input to frame finished"));
 
-        calculate_skin();
-    }
+    target.unbind();
+    target.destroy();
+    renderer.destroy();
+    get_profiler().close_csv();
+
+    return 0;
 }
 
 GLFWwindow* initialize()
@@ -617,99 +881,150 @@ GLFWwindow* initialize()
     return window;
 }
 
-std::string read_shader(std::string path)
+// Parses a whole positive number, rejecting trailing characters
+template <typename T>
+bool parse_positive(const char *text, T &value)
 {
-    std::string result;
+    auto end = text + std::strlen(text);
+    auto [last, error] = std::from_chars(text, end, value);
 
-    std::string line;
-    std::ifstream file(path);
+    return error == std::errc() && last == end && value > 0;
+}
 
-    while (std::getline(file, line))
+int main(int argc, char **argv)
+{
+    std::string file_command;
+    std::string input_path;
+    std::string output_path;
+    size_t chunk_circles = SKIN_FILE_CHUNK_CIRCLES;
+    bool mixed_precision = false;
+    bool load_scene_file = false;
+    BatchRenderOptions batch_render_options;
+    std::string record_trace_path;
+    std::string replay_trace_path;
+    std::string replay_csv_path;
+    bool replay_realtime = false;
+
+    for (auto i = 1; i < argc; i++)
     {
-        result += line;
-        result += "\n";
-    }
+        auto argument = std::string(argv[i]);
 
-    return result;
-}
+        if ((argument == "--import" || argument == "--skin") && i + 2 < argc)
+        {
+            file_command = argument;
+            input_path = argv[++i];
+            output_path = argv[++i];
+        }
 
-unsigned int get_shader_program()
-{
-    auto vertex_shader = read_shader("src/vertex.glsl");
-    auto fragment_shader = read_shader("src/fragment.glsl");
+        if (argument == "--render" && i + 2 < argc)
+        {
+            batch_render_options.list_path = argv[++i];
+            batch_render_options.output_directory = argv[++i];
+        }
 
-    const char *vertex_shader_source = vertex_shader.c_str();
-    const char *fragment_shader_source = fragment_shader.c_str();
+        if (argument == "--size")
+        {
+            if (i + 2 >= argc)
+            {
+                fmt::println("Missing value for {}", argument);
+                return 1;
+            }
 
-    unsigned int vertexShader;
-    vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertexShader, 1, &vertex_shader_source, nullptr);
-    glCompileShader(vertexShader);
+            if (!parse_positive(argv[i + 1], batch_render_options.width) ||
+                !parse_positive(argv[i + 2], batch_render_options.height))
+            {
+                fmt::println("Invalid value {} {} for {}", argv[i + 1], argv[i + 2], argument);
+                return 1;
+            }
 
-    unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragmentShader, 1, &fragment_shader_source, nullptr);
-    glCompileShader(fragmentShader);
+            i += 2;
+        }
 
-    unsigned int shader_program = glCreateProgram();
-    glAttachShader(shader_program, vertexShader);
-    glAttachShader(shader_program, fragmentShader);
+        if (argument == "--format" && i + 1 < argc)
+        {
+            batch_render_options.format = argv[++i];
+        }
 
-    glLinkProgram(shader_program);
+        if (argument == "--chunk")
+        {
+            if (i + 1 >= argc)
+            {
+                fmt::println("Missing value for {}", argument);
+                return 1;
+            }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+            if (!parse_positive(argv[++i], chunk_circles))
+            {
+                fmt::println("Invalid value {} for {}", argv[i], argument);
+                return 1;
+            }
+        }
 
-    return shader_program;
-}
+        if (argument == "--precision" && i + 1 < argc)
+        {
+            mixed_precision = std::string(argv[++i]) == "mixed";
+        }
 
-void render_circles(unsigned int vbo, unsigned int vao, std::vector<Circle> circles, GLint model_uniform)
-{
-    for (auto circle : circles)
-    {
-        auto model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(circle.position, 0.0f));
-        model = glm::scale(model, glm::vec3(circle.radius, circle.radius, 1.0f));
+        if (argument == "--scene" && i + 1 < argc)
+        {
+            scene_path = argv[++i];
+            load_scene_file = true;
+        }
 
-        auto vertex_data = circle.get_vertex_data();
+        if (argument == "--profile-csv" && i + 1 < argc)
+        {
+            profile_csv_open = get_profiler().open_csv(argv[++i]);
 
-        glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model));
+            if (!profile_csv_open)
+            {
+                fmt::println("Failed to open {}", argv[i]);
+                return 1;
+            }
 
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, vertex_data.size() * sizeof(vertex_data[0]), &vertex_data[0], GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+            get_profiler().set_enabled(true);
+        }
 
-        glBindVertexArray(vao);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glDrawArrays(GL_TRIANGLES, 0, vertex_data.size());
-        glBindVertexArray(0);
-    }
-}
+        if (argument == "--latency-report")
+        {
+            report_latency = true;
+        }
 
-void render_curves(unsigned int vbo, unsigned int vao, std::vector<HermiteCurve> curves, GLint model_uniform)
-{
-    for (auto curve : curves)
-    {
-        auto model = glm::mat4(1.0f);
+        if (argument == "--record-trace" && i + 1 < argc)
+        {
+            record_trace_path = argv[++i];
+        }
 
-        auto vertex_data = curve.get_vertex_data(30);
+        if (argument == "--replay-trace" && i + 1 < argc)
+        {
+            replay_trace_path = argv[++i];
+        }
 
-        glUniformMatrix4fv(model_uniform, 1, GL_FALSE, glm::value_ptr(model));
+        if (argument == "--replay-speed" && i + 1 < argc)
+        {
+            replay_realtime = std::string(argv[++i]) == "realtime";
+        }
 
-        glLineWidth(3.0f);
+        if (argument == "--replay-csv" && i + 1 < argc)
+        {
+            replay_csv_path = argv[++i];
+        }
+    }
 
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glBufferData(GL_ARRAY_BUFFER, vertex_data.size() * sizeof(vertex_data[0]), &vertex_data[0], GL_STATIC_DRAW);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (!file_command.empty())
+    {
+        return run_file_command(file_command, input_path, output_path, chunk_circles, mixed_precision);
+    }
 
-        glBindVertexArray(vao);
-        glBindBuffer(GL_ARRAY_BUFFER, vbo);
-        glDrawArrays(GL_LINE_STRIP, 0, vertex_data.size() / 5);
-        glBindVertexArray(0);
+    if (!batch_render_options.list_path.empty())
+    {
+        return render_scene_batch(batch_render_options);
+    }
+
+    if (!replay_trace_path.empty())
+    {
+        return replay_input_trace(replay_trace_path, replay_realtime, replay_csv_path, load_scene_file);
     }
-}
 
-int main()
-{
     auto window = initialize();
 
     if (window == nullptr)
@@ -720,65 +1035,103 @@ int main()
 
     glViewport(0, 0, window_width, window_height);
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwSetWindowRefreshCallback(window, window_refresh_callback);
     glfwSetCursorPosCallback(window, cursor_position_callback);
     glfwSetMouseButtonCallback(window, mouse_button_callback);
     glfwSetScrollCallback(window, scroll_callback);
+    glfwSetKeyCallback(window, key_callback);
 
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
 
-    auto shader_program = get_shader_program();
+    if (!renderer.initialize())
+    {
+        fmt::println("Failed to create shader programs");
+        glfwTerminate();
+        return 1;
+    }
+
+    gpu_timers.initialize();
+    renderer.gpu_timers = &gpu_timers;
+
+    initialize_scene(load_scene_file);
+
+    // Started once the scene is loaded, a replay starts from the same state
+    if (!record_trace_path.empty() && !input_trace.open(record_trace_path, window_width, window_height, scene.get_circle_count()))
+    {
+        fmt::println("Failed to open {}", record_trace_path);
+    }
 
-    auto model_uniform = glGetUniformLocation(shader_program, "model");
-    auto projection_uniform = glGetUniformLocation(shader_program, "projection");
+    while(!glfwWindowShouldClose(window))
+    {
+        ScopedTimer frame_timer(ProfileStage::Frame);
 
-    unsigned int circle_vbo;
-    unsigned int circle_vao;
+        // All events since the last frame are already handled, so this runs once for all of them
+        update_skin();
 
-    unsigned int hermite_vbo;
-    unsigned int hermite_vao;
+        // Nothing changed since the last frame, the front buffer is still valid
+        if (redraw_requested)
+        {
+            redraw_requested = false;
 
-    glGenBuffers(1, &circle_vbo);
-    glGenVertexArrays(1, &circle_vao);
+            gpu_timers.begin_frame();
+            draw_scene();
+            gpu_timers.end_frame(frame_input_time);
+            glfwSwapBuffers(window);
 
-    glBindVertexArray(circle_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, circle_vbo);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+            if (frame_input_time != LatencyClock::time_point())
+            {
+                swap_latency.add(std::chrono::duration<double, std::milli>(LatencyClock::now() - frame_input_time).count());
+                frame_input_time = LatencyClock::time_point();
+            }
 
-    glGenBuffers(1, &hermite_vbo);
-    glGenVertexArrays(1, &hermite_vao);
+            frame_timer.stop();
 
-    glBindVertexArray(hermite_vao);
-    glBindBuffer(GL_ARRAY_BUFFER, hermite_vbo);
-    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(2 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+            record_gpu_times();
 
-    circles = std::vector<Circle>();
-    point_circles = std::vector<Circle>();
-    curves = std::vector<HermiteCurve>();
+            if (get_profiler().is_enabled())
+            {
+                get_profiler().end_frame();
+            }
+        }
+        else
+        {
+            frame_timer.stop();
+        }
 
-    while(!glfwWindowShouldClose(window))
-    {
-        glClear(GL_COLOR_BUFFER_BIT);
+        glfwWaitEvents();
+    }
 
-        glUseProgram(shader_program);
+    skin_worker.stop();
 
-        auto projection = glm::ortho(0.0f, window_width, window_height, 0.0f, -1.0f, 1.0f);
+    if (input_trace.is_open())
+    {
+        auto event_count = input_trace.get_event_count();
 
-        glUniformMatrix4fv(projection_uniform, 1, GL_FALSE, glm::value_ptr(projection));
+        if (input_trace.close())
+        {
+            fmt::println("Recorded {} input events to {}", event_count, record_trace_path);
+        }
+        else
+        {
+            fmt::println("Failed to write the input trace {}", record_trace_path);
+        }
+    }
 
-        render_circles(circle_vbo, circle_vao, circles, model_uniform);
-        render_circles(circle_vbo, circle_vao, point_circles, model_uniform);
-        render_curves(hermite_vbo, hermite_vao, curves, model_uniform);
+    if (report_latency)
+    {
+        // The last frames are still in flight, everything is available after glFinish
+        glFinish();
+        record_gpu_times();
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        fmt::print("{}", swap_latency.get_report("Input to swap"));
+        fmt::print("{}", gpu_latency.get_report("Input to GPU finished"));
     }
 
+    gpu_timers.destroy();
+    overlay.destroy();
+    renderer.destroy();
+    get_profiler().close_csv();
+
     glfwTerminate();
     return 0;
 }
@@ -0,0 +1,163 @@
+#include <cstring>
+#include <offscreen_target.hpp>
+
+bool OffscreenTarget::initialize(int width, int height)
+{
+    destroy();
+
+    this->width = width;
+    this->height = height;
+
+    glGenRenderbuffers(1, &color_renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, color_renderbuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, color_renderbuffer);
+
+    auto complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    for (auto &slot : slots)
+    {
+        glGenBuffers(1, &slot.pbo);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (size_t)width * height * 4, nullptr, GL_STREAM_READ);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    if (!complete)
+    {
+        destroy();
+        return false;
+    }
+
+    return true;
+}
+
+void OffscreenTarget::destroy()
+{
+    for (auto &slot : slots)
+    {
+        if (slot.fence != nullptr)
+        {
+            glDeleteSync(slot.fence);
+        }
+
+        glDeleteBuffers(1, &slot.pbo);
+        slot = {};
+    }
+
+    glDeleteFramebuffers(1, &framebuffer);
+    glDeleteRenderbuffers(1, &color_renderbuffer);
+
+    framebuffer = 0;
+    color_renderbuffer = 0;
+    width = 0;
+    height = 0;
+    frame_index = 0;
+    oldest_pending = 0;
+}
+
+int OffscreenTarget::get_width() const
+{
+    return width;
+}
+
+int OffscreenTarget::get_height() const
+{
+    return height;
+}
+
+void OffscreenTarget::bind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+}
+
+void OffscreenTarget::unbind()
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+size_t OffscreenTarget::get_pending_count() const
+{
+    return frame_index - oldest_pending;
+}
+
+bool OffscreenTarget::read_back(uint64_t tag)
+{
+    if (get_pending_count() == OFFSCREEN_PBO_COUNT)
+    {
+        return false;
+    }
+
+    auto &slot = slots[frame_index % OFFSCREEN_PBO_COUNT];
+
+    // With a pack buffer bound the read only queues a copy on the GPU and returns at once
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.tag = tag;
+    frame_index++;
+
+    // Fences are only guaranteed to signal once the commands before them were submitted
+    glFlush();
+
+    return true;
+}
+
+bool OffscreenTarget::acquire(OffscreenImage &image, bool wait)
+{
+    if (oldest_pending == frame_index)
+    {
+        return false;
+    }
+
+    auto &slot = slots[oldest_pending % OFFSCREEN_PBO_COUNT];
+    auto status = glClientWaitSync(slot.fence, 0, wait ? GL_TIMEOUT_IGNORED : 0);
+
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+    {
+        return false;
+    }
+
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    auto row_size = (size_t)width * 4;
+
+    image.tag = slot.tag;
+    image.width = width;
+    image.height = height;
+    image.pixels.resize(row_size * height);
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+
+    auto data = (const uint8_t *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, row_size * height, GL_MAP_READ_BIT);
+
+    if (data != nullptr)
+    {
+        // GL rows start at the bottom
+        for (int y = 0; y < height; y++)
+        {
+            std::memcpy(&image.pixels[y * row_size], data + (height - 1 - y) * row_size, row_size);
+        }
+
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    oldest_pending++;
+
+    return data != nullptr;
+}
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <profiler.hpp>
+
+const char *get_profile_stage_name(ProfileStage stage)
+{
+    switch (stage)
+    {
+        case ProfileStage::TouchingCircles: return "touching_circles";
+        case ProfileStage::Separation: return "separation";
+        case ProfileStage::Tangents: return "tangents";
+        case ProfileStage::Culling: return "culling";
+        case ProfileStage::Tessellation: return "tessellation";
+        case ProfileStage::Upload: return "upload";
+        case ProfileStage::Draw: return "draw";
+        case ProfileStage::Frame: return "frame";
+        case ProfileStage::GpuCircles: return "gpu_circles";
+        case ProfileStage::GpuCurves: return "gpu_curves";
+    }
+
+    return "unknown";
+}
+
+Profiler &get_profiler()
+{
+    static Profiler profiler;
+
+    return profiler;
+}
+
+void Profiler::set_enabled(bool value)
+{
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+void Profiler::end_frame()
+{
+    auto slot = frame_count % PROFILE_HISTORY_FRAMES;
+
+    for (auto stage = 0; stage < PROFILE_STAGE_COUNT; stage++)
+    {
+        history[stage][slot] = frame_nanoseconds[stage].exchange(0, std::memory_order_relaxed) / 1000.0f;
+    }
+
+    if (csv.is_open())
+    {
+        csv << frame_count;
+
+        for (auto stage = 0; stage < PROFILE_STAGE_COUNT; stage++)
+        {
+            csv << ',' << history[stage][slot];
+        }
+
+        csv << '\n';
+    }
+
+    frame_count++;
+}
+
+size_t Profiler::get_frame_count() const
+{
+    return frame_count;
+}
+
+ProfileStats Profiler::get_stats(ProfileStage stage) const
+{
+    auto count = std::min(frame_count, (size_t)PROFILE_HISTORY_FRAMES);
+
+    if (count == 0)
+    {
+        return ProfileStats{0.0, 0.0, 0.0};
+    }
+
+    float sorted[PROFILE_HISTORY_FRAMES];
+    std::copy(history[(int)stage], history[(int)stage] + count, sorted);
+
+    auto p99 = sorted + (count * 99) / 100;
+    std::nth_element(sorted, p99, sorted + count);
+
+    double sum = 0.0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        sum += sorted[i];
+    }
+
+    return ProfileStats{*std::min_element(sorted, sorted + count), sum / count, *p99};
+}
+
+bool Profiler::open_csv(const std::string &path)
+{
+    csv.open(path);
+
+    if (!csv.is_open())
+    {
+        return false;
+    }
+
+    // Microseconds per stage, one row per frame
+    csv << "frame";
+
+    for (auto stage = 0; stage < PROFILE_STAGE_COUNT; stage++)
+    {
+        csv << ',' << get_profile_stage_name((ProfileStage)stage) << "_us";
+    }
+
+    csv << '\n';
+
+    return true;
+}
+
+void Profiler::close_csv()
+{
+    csv.close();
+}
@@ -0,0 +1,198 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <program_cache.hpp>
+#include <random>
+#include <vector>
+
+#define PROGRAM_CACHE_MAGIC "CSKP"
+
+struct ProgramCacheHeader
+{
+    char magic[4];
+    uint32_t binary_format;
+    uint64_t key;
+};
+
+// FNV-1a, the key only has to tell programs apart, not resist collisions on purpose
+static uint64_t hash_bytes(uint64_t hash, const void *data, size_t size)
+{
+    auto bytes = (const uint8_t *)data;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+    }
+
+    return hash;
+}
+
+static uint64_t hash_string(uint64_t hash, const char *text)
+{
+    // The terminator separates consecutive strings, "ab" + "c" differs from "a" + "bc"
+    return hash_bytes(hash, text != nullptr ? text : "", text != nullptr ? std::strlen(text) + 1 : 1);
+}
+
+static bool supports_program_binaries()
+{
+    GLint format_count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+
+    return format_count > 0;
+}
+
+static std::filesystem::path get_program_cache_path(uint64_t key)
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+
+    return get_program_cache_directory() / name;
+}
+
+std::filesystem::path get_program_cache_directory()
+{
+    if (auto directory = std::getenv("CIRCLE_SKINNING_SHADER_CACHE"); directory != nullptr && *directory != '\0')
+    {
+        return directory;
+    }
+
+#ifdef _WIN32
+    if (auto directory = std::getenv("LOCALAPPDATA"); directory != nullptr)
+    {
+        return std::filesystem::path(directory) / "circle-skinning" / "shaders";
+    }
+#else
+    if (auto directory = std::getenv("XDG_CACHE_HOME"); directory != nullptr && *directory != '\0')
+    {
+        return std::filesystem::path(directory) / "circle-skinning" / "shaders";
+    }
+
+    if (auto directory = std::getenv("HOME"); directory != nullptr)
+    {
+        return std::filesystem::path(directory) / ".cache" / "circle-skinning" / "shaders";
+    }
+#endif
+
+    std::error_code error;
+    return std::filesystem::temp_directory_path(error) / "circle-skinning-shaders";
+}
+
+uint64_t get_program_cache_key(std::span<const ShaderStageSource> stages)
+{
+    auto hash = 0xCBF29CE484222325ull;
+
+    hash = hash_string(hash, (const char *)glGetString(GL_VENDOR));
+    hash = hash_string(hash, (const char *)glGetString(GL_RENDERER));
+    hash = hash_string(hash, (const char *)glGetString(GL_VERSION));
+
+    for (auto &stage : stages)
+    {
+        hash = hash_bytes(hash, &stage.type, sizeof(stage.type));
+        hash = hash_string(hash, stage.source.c_str());
+    }
+
+    return hash;
+}
+
+unsigned int load_cached_program(uint64_t key)
+{
+    if (!supports_program_binaries())
+    {
+        return 0;
+    }
+
+    std::ifstream file(get_program_cache_path(key), std::ios::binary | std::ios::ate);
+
+    if (!file)
+    {
+        return 0;
+    }
+
+    auto size = (size_t)file.tellg();
+    ProgramCacheHeader header;
+
+    if (size <= sizeof(header))
+    {
+        return 0;
+    }
+
+    std::vector<char> binary(size - sizeof(header));
+
+    file.seekg(0);
+    file.read((char *)&header, sizeof(header));
+    file.read(binary.data(), binary.size());
+
+    if (!file || std::memcmp(header.magic, PROGRAM_CACHE_MAGIC, 4) != 0 || header.key != key)
+    {
+        return 0;
+    }
+
+    auto program = glCreateProgram();
+    glProgramBinary(program, header.binary_format, binary.data(), binary.size());
+
+    // Drivers may reject their own binaries, e.g. after an update that kept the version string
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    if (linked != GL_TRUE)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+void store_cached_program(uint64_t key, unsigned int program)
+{
+    if (!supports_program_binaries())
+    {
+        return;
+    }
+
+    GLint size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+
+    if (size <= 0)
+    {
+        return;
+    }
+
+    ProgramCacheHeader header = {};
+    std::memcpy(header.magic, PROGRAM_CACHE_MAGIC, 4);
+    header.key = key;
+
+    std::vector<char> binary(size);
+    GLenum binary_format = 0;
+    glGetProgramBinary(program, size, nullptr, &binary_format, binary.data());
+    header.binary_format = binary_format;
+
+    auto path = get_program_cache_path(key);
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    // Written under a unique name and renamed, so concurrent jobs never read a partial file
+    auto temporary_path = path;
+    temporary_path += "." + std::to_string(std::random_device()()) + ".tmp";
+
+    {
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+
+        file.write((const char *)&header, sizeof(header));
+        file.write(binary.data(), binary.size());
+
+        if (!file)
+        {
+            file.close();
+            std::filesystem::remove(temporary_path, error);
+            return;
+        }
+    }
+
+    std::filesystem::rename(temporary_path, path, error);
+
+    if (error)
+    {
+        std::filesystem::remove(temporary_path, error);
+    }
+}
@@ -0,0 +1,671 @@
+#include <glad/glad.h>
+#include <cstddef>
+#include <embedded_shaders.hpp>
+#include <fmt/core.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <profiler.hpp>
+#include <program_cache.hpp>
+#include <renderer.hpp>
+
+// Finest fixed-point step of curve vertices in pixels, a batch spans up to 65534 steps
+#define CURVE_FIXED_POINT_STEP (1.0f / 16.0f)
+// The view is grown by this many pixels before culling, curves are drawn 3 pixels wide
+#define CULL_MARGIN_PIXELS 2.0f
+
+// Triangle strip over the square around the unit circle, as 16-bit normalized integers
+static const short quad_corners[] = { -32767, -32767, 32767, -32767, -32767, 32767, 32767, 32767 };
+
+std::string read_shader(std::string name)
+{
+    // Sources are compiled into the executable, so the working directory does not matter
+    for (size_t i = 0; i < embedded_shader_count; i++)
+    {
+        if (name == embedded_shaders[i].name)
+        {
+            return embedded_shaders[i].source;
+        }
+    }
+
+    fmt::println("Unknown shader {}", name);
+
+    return std::string();
+}
+
+static unsigned int compile_shader_source(GLenum type, const std::string &shader_source)
+{
+    const char *source = shader_source.c_str();
+
+    unsigned int shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+
+    if (compiled != GL_TRUE)
+    {
+        char log[1024] = {};
+        glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+        fmt::println("Failed to compile shader: {}", log);
+
+        glDeleteShader(shader);
+        return 0;
+    }
+
+    return shader;
+}
+
+unsigned int compile_shader(GLenum type, std::string name)
+{
+    return compile_shader_source(type, read_shader(name));
+}
+
+// Loads the program from the binary cache, or compiles and links it and fills the cache
+static unsigned int get_cached_program(std::span<const ShaderStageSource> stages)
+{
+    auto key = get_program_cache_key(stages);
+
+    if (auto program = load_cached_program(key); program != 0)
+    {
+        return program;
+    }
+
+    unsigned int shader_program = glCreateProgram();
+    auto compiled = true;
+
+    for (auto &stage : stages)
+    {
+        auto shader = compile_shader_source(stage.type, stage.source);
+
+        if (shader == 0)
+        {
+            compiled = false;
+            continue;
+        }
+
+        // Stays alive until the program is deleted or linked below
+        glAttachShader(shader_program, shader);
+        glDeleteShader(shader);
+    }
+
+    if (!compiled)
+    {
+        glDeleteProgram(shader_program);
+        return 0;
+    }
+
+    glProgramParameteri(shader_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(shader_program);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(shader_program, GL_LINK_STATUS, &linked);
+
+    if (linked != GL_TRUE)
+    {
+        char log[1024] = {};
+        glGetProgramInfoLog(shader_program, sizeof(log), nullptr, log);
+        fmt::println("Failed to link shader program: {}", log);
+
+        glDeleteProgram(shader_program);
+        return 0;
+    }
+
+    store_cached_program(key, shader_program);
+
+    return shader_program;
+}
+
+unsigned int get_shader_program(std::string vertex_name, std::string fragment_name)
+{
+    ShaderStageSource stages[] = {
+        { GL_VERTEX_SHADER, read_shader(vertex_name) },
+        { GL_FRAGMENT_SHADER, read_shader(fragment_name) },
+    };
+
+    return get_cached_program(stages);
+}
+
+unsigned int get_tessellation_shader_program(std::string vertex_name, std::string tess_control_name, std::string tess_eval_name, std::string fragment_name)
+{
+    ShaderStageSource stages[] = {
+        { GL_VERTEX_SHADER, read_shader(vertex_name) },
+        { GL_TESS_CONTROL_SHADER, read_shader(tess_control_name) },
+        { GL_TESS_EVALUATION_SHADER, read_shader(tess_eval_name) },
+        { GL_FRAGMENT_SHADER, read_shader(fragment_name) },
+    };
+
+    return get_cached_program(stages);
+}
+
+static void pack_color(glm::vec3 color, uint8_t *packed)
+{
+    packed[0] = (uint8_t)glm::round(glm::clamp(color.x, 0.0f, 1.0f) * 255.0f);
+    packed[1] = (uint8_t)glm::round(glm::clamp(color.y, 0.0f, 1.0f) * 255.0f);
+    packed[2] = (uint8_t)glm::round(glm::clamp(color.z, 0.0f, 1.0f) * 255.0f);
+    packed[3] = 255;
+}
+
+void SceneRenderer::create_circle_batch(CircleBatch &batch)
+{
+    glGenVertexArrays(1, &batch.vao);
+    glGenBuffers(1, &batch.instance_vbo);
+
+    glBindVertexArray(batch.vao);
+
+    glBindBuffer(GL_ARRAY_BUFFER, quad_vbo);
+    glVertexAttribPointer(0, 2, GL_SHORT, GL_TRUE, 2 * sizeof(short), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    glBindBuffer(GL_ARRAY_BUFFER, batch.instance_vbo);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(CircleInstance), (void*)offsetof(CircleInstance, x));
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(CircleInstance), (void*)offsetof(CircleInstance, radius));
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    glVertexAttribPointer(1, 3, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CircleInstance), (void*)offsetof(CircleInstance, color));
+    glEnableVertexAttribArray(1);
+    glVertexAttribDivisor(1, 1);
+
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SceneRenderer::build_circle_tiles(CircleBatch &batch, std::span<const Circle> circles)
+{
+    ScopedTimer timer(ProfileStage::Culling);
+
+    bounds_low.resize(circles.size());
+    bounds_high.resize(circles.size());
+
+    for (size_t i = 0; i < circles.size(); i++)
+    {
+        bounds_low[i] = circles[i].position - glm::vec2(circles[i].radius);
+        bounds_high[i] = circles[i].position + glm::vec2(circles[i].radius);
+    }
+
+    batch.tiles.build(bounds_low, bounds_high);
+}
+
+void SceneRenderer::upload_circle_batch(CircleBatch &batch, std::span<const Circle> circles, float scale, const TileRange &tiles)
+{
+    ScopedTimer timer(ProfileStage::Upload);
+
+    batch.tiles.query(tiles, visible_objects);
+
+    // The sprite covers the circle and the one pixel anti-aliasing band around it
+    auto max_sprite_radius = glm::min(CIRCLE_SPRITE_MAX_RADIUS, max_point_size / 2.0f - 1.0f);
+
+    batch.sprite_count = 0;
+
+    for (auto index : visible_objects)
+    {
+        batch.sprite_count += circles[index].radius * scale <= max_sprite_radius;
+    }
+
+    int next_quad = 0;
+    int next_sprite = visible_objects.size() - batch.sprite_count;
+
+    instance_data.resize(visible_objects.size());
+
+    for (auto index : visible_objects)
+    {
+        auto &circle = circles[index];
+        auto &instance = instance_data[circle.radius * scale <= max_sprite_radius ? next_sprite++ : next_quad++];
+
+        instance.x = circle.position.x;
+        instance.y = circle.position.y;
+        instance.radius = circle.radius;
+        pack_color(circle.color, instance.color);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, batch.instance_vbo);
+    glBufferData(GL_ARRAY_BUFFER, instance_data.size() * sizeof(CircleInstance), instance_data.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    batch.instance_count = visible_objects.size();
+    batch.uploaded_scale = scale;
+    batch.uploaded_tiles = tiles;
+    batch.dirty = false;
+}
+
+void SceneRenderer::render_circle_batch(CircleBatch &batch)
+{
+    if (batch.instance_count == 0)
+    {
+        return;
+    }
+
+    glBindVertexArray(batch.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, batch.instance_vbo);
+
+    auto quad_count = batch.instance_count - batch.sprite_count;
+
+    if (quad_count > 0)
+    {
+        glUniform1i(circle_point_sprites_uniform, GL_FALSE);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, quad_count);
+    }
+
+    if (batch.sprite_count > 0)
+    {
+        // GL 4.1 has no base instance, so the instance attributes are pointed at the sprites instead
+        auto offset = quad_count * sizeof(CircleInstance);
+
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(CircleInstance), (void*)(offset + offsetof(CircleInstance, x)));
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(CircleInstance), (void*)(offset + offsetof(CircleInstance, radius)));
+        glVertexAttribPointer(1, 3, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CircleInstance), (void*)(offset + offsetof(CircleInstance, color)));
+
+        glUniform1i(circle_point_sprites_uniform, GL_TRUE);
+        glDrawArraysInstanced(GL_POINTS, 0, 1, batch.sprite_count);
+
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(CircleInstance), (void*)offsetof(CircleInstance, x));
+        glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, sizeof(CircleInstance), (void*)offsetof(CircleInstance, radius));
+        glVertexAttribPointer(1, 3, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CircleInstance), (void*)offsetof(CircleInstance, color));
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void SceneRenderer::build_curve_tiles(std::span<const HermiteCurve> curves)
+{
+    ScopedTimer timer(ProfileStage::Culling);
+
+    bounds_low.resize(curves.size());
+    bounds_high.resize(curves.size());
+
+    for (size_t i = 0; i < curves.size(); i++)
+    {
+        curves[i].get_bounds(bounds_low[i], bounds_high[i]);
+    }
+
+    curve_tiles.build(bounds_low, bounds_high);
+    curve_tiles_dirty = false;
+}
+
+void SceneRenderer::upload_curves(std::span<const HermiteCurve> curves, float scale, const TileRange &tiles)
+{
+    ScopedTimer tessellation_timer(ProfileStage::Tessellation);
+
+    curve_tiles.query(tiles, visible_objects);
+
+    curve_vertex_data.clear();
+    curve_firsts.clear();
+    curve_counts.clear();
+    curve_batches.clear();
+
+    // Steps are kept in pixels, so zooming in keeps the same on-screen precision
+    auto min_step = CURVE_FIXED_POINT_STEP / scale;
+
+    for (auto index : visible_objects)
+    {
+        auto &curve = curves[index];
+        auto segments = curve_segments > 0 ? curve_segments : curve.get_segment_count(curve_tolerance, scale);
+
+        curve_points.clear();
+        curve.append_points(curve_points, segments);
+
+        auto low = curve_points[0];
+        auto high = curve_points[0];
+
+        for (auto point : curve_points)
+        {
+            low = glm::min(low, point);
+            high = glm::max(high, point);
+        }
+
+        // Coarser than min_step only for curves too long for 16 bits
+        auto extent = glm::max(high.x - low.x, high.y - low.y);
+        auto step = glm::max(min_step, extent / 65534.0f);
+
+        // A batch opened by a longer curve would quantize this one at its coarser step
+        auto batch = curve_batches.empty() ? nullptr : &curve_batches.back();
+        auto fits = batch != nullptr && batch->color == curve.get_color() && batch->step <= step;
+
+        for (size_t j = 0; fits && j < curve_points.size(); j++)
+        {
+            auto offset = glm::abs(curve_points[j] - batch->origin) / batch->step;
+
+            fits = offset.x <= 32767.0f && offset.y <= 32767.0f;
+        }
+
+        if (!fits)
+        {
+            curve_batches.push_back(CurveDrawBatch{(low + high) / 2.0f, step, curve.get_color(), (int)curve_counts.size(), 0});
+            batch = &curve_batches.back();
+        }
+
+        batch->curve_count++;
+
+        curve_firsts.push_back(curve_vertex_data.size());
+
+        for (auto point : curve_points)
+        {
+            auto fixed = glm::clamp((point - batch->origin) / batch->step, glm::vec2(-32767.0f), glm::vec2(32767.0f));
+
+            curve_vertex_data.push_back(CurveVertex{(int16_t)glm::round(fixed.x), (int16_t)glm::round(fixed.y)});
+        }
+
+        curve_counts.push_back(curve_vertex_data.size() - curve_firsts.back());
+    }
+
+    tessellation_timer.stop();
+
+    ScopedTimer upload_timer(ProfileStage::Upload);
+
+    glBindBuffer(GL_ARRAY_BUFFER, curve_vbo);
+    glBufferData(GL_ARRAY_BUFFER, curve_vertex_data.size() * sizeof(CurveVertex), curve_vertex_data.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    curves_dirty = false;
+    tessellated_segments = curve_segments;
+    tessellated_tolerance = curve_tolerance;
+    tessellated_scale = scale;
+    tessellated_tiles = tiles;
+}
+
+void SceneRenderer::upload_patches(std::span<const HermiteCurve> curves, const TileRange &tiles)
+{
+    ScopedTimer timer(ProfileStage::Upload);
+
+    curve_tiles.query(tiles, visible_objects);
+    patch_data.resize(visible_objects.size());
+
+    for (size_t i = 0; i < visible_objects.size(); i++)
+    {
+        auto &curve = curves[visible_objects[i]];
+        auto &patch = patch_data[i];
+
+        patch.p0 = curve.get_p0();
+        patch.p1 = curve.get_p1();
+        patch.v0 = curve.get_v0();
+        patch.v1 = curve.get_v1();
+        pack_color(curve.get_color(), patch.color);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, patch_vbo);
+    glBufferData(GL_ARRAY_BUFFER, patch_data.size() * sizeof(CurvePatch), patch_data.data(), GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    patch_count = patch_data.size();
+    patch_tiles = tiles;
+    patches_dirty = false;
+}
+
+void SceneRenderer::render_curve_strips(const glm::mat4 &projection)
+{
+    if (curve_counts.empty())
+    {
+        return;
+    }
+
+    glUseProgram(curve_program);
+    glUniformMatrix4fv(curve_projection_uniform, 1, GL_FALSE, glm::value_ptr(projection));
+
+    glLineWidth(3.0f);
+
+    glBindVertexArray(curve_vao);
+
+    for (auto &batch : curve_batches)
+    {
+        glUniform2f(curve_origin_uniform, batch.origin.x, batch.origin.y);
+        glUniform1f(curve_step_uniform, batch.step);
+        glUniform3f(curve_color_uniform, batch.color.x, batch.color.y, batch.color.z);
+
+        glMultiDrawArrays(GL_LINE_STRIP, &curve_firsts[batch.first_curve], &curve_counts[batch.first_curve], batch.curve_count);
+    }
+}
+
+void SceneRenderer::render_curve_patches(const glm::mat4 &projection)
+{
+    if (patch_count == 0)
+    {
+        return;
+    }
+
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    glUseProgram(hermite_program);
+    glUniformMatrix4fv(hermite_projection_uniform, 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform2f(hermite_viewport_uniform, (float)viewport[2], (float)viewport[3]);
+    glUniform1i(hermite_segments_uniform, curve_segments);
+    glUniform1f(hermite_tolerance_uniform, curve_tolerance);
+
+    glLineWidth(3.0f);
+
+    glBindVertexArray(patch_vao);
+    glPatchParameteri(GL_PATCH_VERTICES, 1);
+    glDrawArrays(GL_PATCHES, 0, patch_count);
+}
+
+bool SceneRenderer::initialize()
+{
+    circle_program = get_shader_program("circle_vertex.glsl", "circle_fragment.glsl");
+    curve_program = get_shader_program("vertex.glsl", "fragment.glsl");
+
+    circle_projection_uniform = glGetUniformLocation(circle_program, "projection");
+    circle_pixel_size_uniform = glGetUniformLocation(circle_program, "pixel_size");
+    circle_point_sprites_uniform = glGetUniformLocation(circle_program, "point_sprites");
+    curve_projection_uniform = glGetUniformLocation(curve_program, "projection");
+    curve_origin_uniform = glGetUniformLocation(curve_program, "origin");
+    curve_step_uniform = glGetUniformLocation(curve_program, "fixed_point_step");
+    curve_color_uniform = glGetUniformLocation(curve_program, "color");
+
+    glGenBuffers(1, &quad_vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, quad_vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(quad_corners), quad_corners, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    GLfloat point_size_range[2];
+    glGetFloatv(GL_POINT_SIZE_RANGE, point_size_range);
+    max_point_size = point_size_range[1];
+
+    // Sprites take their size from gl_PointSize
+    glEnable(GL_PROGRAM_POINT_SIZE);
+
+    create_circle_batch(circle_batch);
+    create_circle_batch(marker_batch);
+
+    glGenBuffers(1, &curve_vbo);
+    glGenVertexArrays(1, &curve_vao);
+
+    glBindVertexArray(curve_vao);
+    glBindBuffer(GL_ARRAY_BUFFER, curve_vbo);
+    glVertexAttribPointer(0, 2, GL_SHORT, GL_FALSE, sizeof(CurveVertex), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    hermite_program = get_tessellation_shader_program("hermite_vertex.glsl", "hermite_tess_control.glsl", "hermite_tess_eval.glsl", "fragment.glsl");
+
+    if (hermite_program != 0)
+    {
+        hermite_projection_uniform = glGetUniformLocation(hermite_program, "projection");
+        hermite_viewport_uniform = glGetUniformLocation(hermite_program, "viewport");
+        hermite_segments_uniform = glGetUniformLocation(hermite_program, "segments");
+        hermite_tolerance_uniform = glGetUniformLocation(hermite_program, "tolerance");
+
+        glGenBuffers(1, &patch_vbo);
+        glGenVertexArrays(1, &patch_vao);
+
+        glBindVertexArray(patch_vao);
+        glBindBuffer(GL_ARRAY_BUFFER, patch_vbo);
+        glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(CurvePatch), (void*)offsetof(CurvePatch, p0));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, sizeof(CurvePatch), (void*)offsetof(CurvePatch, v0));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 3, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(CurvePatch), (void*)offsetof(CurvePatch, color));
+        glEnableVertexAttribArray(2);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    return circle_program != 0 && curve_program != 0;
+}
+
+void SceneRenderer::destroy()
+{
+    for (auto batch : { &circle_batch, &marker_batch })
+    {
+        glDeleteVertexArrays(1, &batch->vao);
+        glDeleteBuffers(1, &batch->instance_vbo);
+    }
+
+    glDeleteVertexArrays(1, &curve_vao);
+    glDeleteBuffers(1, &curve_vbo);
+    glDeleteVertexArrays(1, &patch_vao);
+    glDeleteBuffers(1, &patch_vbo);
+    glDeleteBuffers(1, &quad_vbo);
+
+    glDeleteProgram(circle_program);
+    glDeleteProgram(curve_program);
+    glDeleteProgram(hermite_program);
+}
+
+void SceneRenderer::mark_circles_dirty()
+{
+    circle_batch.dirty = true;
+}
+
+void SceneRenderer::mark_skin_dirty()
+{
+    marker_batch.dirty = true;
+    curves_dirty = true;
+    patches_dirty = true;
+    curve_tiles_dirty = true;
+}
+
+bool SceneRenderer::supports_tessellation() const
+{
+    return hermite_program != 0;
+}
+
+void SceneRenderer::set_curve_render_mode(CurveRenderMode mode)
+{
+    if (mode == CurveRenderMode::Tessellation && !supports_tessellation())
+    {
+        return;
+    }
+
+    curve_render_mode = mode;
+}
+
+CurveRenderMode SceneRenderer::get_curve_render_mode() const
+{
+    return curve_render_mode;
+}
+
+size_t SceneRenderer::get_curve_vertex_count() const
+{
+    return curve_vertex_data.size();
+}
+
+size_t SceneRenderer::get_drawn_circle_count() const
+{
+    return circle_batch.instance_count + marker_batch.instance_count;
+}
+
+size_t SceneRenderer::get_drawn_curve_count() const
+{
+    return curve_render_mode == CurveRenderMode::Tessellation ? patch_count : curve_counts.size();
+}
+
+void SceneRenderer::render(const glm::mat4 &projection, std::span<const Circle> circles, std::span<const Circle> point_circles, std::span<const HermiteCurve> curves)
+{
+    GLint viewport[4];
+    glGetIntegerv(GL_VIEWPORT, viewport);
+
+    // Pixels per scene unit, sprite sizes and segment counts follow the zoom
+    auto scale = glm::abs(projection[0][0]) * viewport[2] / 2.0f;
+
+    // The projection is orthographic without rotation, so the corners of clip space map back
+    // to the corners of the view
+    auto translation = glm::vec2(projection[3][0], projection[3][1]);
+    auto axis_scale = glm::vec2(projection[0][0], projection[1][1]);
+    auto corner_a = (glm::vec2(-1.0f) - translation) / axis_scale;
+    auto corner_b = (glm::vec2(1.0f) - translation) / axis_scale;
+    auto margin = glm::vec2(CULL_MARGIN_PIXELS / scale);
+    auto view_low = glm::min(corner_a, corner_b) - margin;
+    auto view_high = glm::max(corner_a, corner_b) + margin;
+
+    for (auto [batch, batch_circles] : { std::pair(&circle_batch, circles), std::pair(&marker_batch, point_circles) })
+    {
+        if (batch->dirty)
+        {
+            build_circle_tiles(*batch, batch_circles);
+        }
+
+        // Panning inside the uploaded tiles needs no upload at all
+        auto tiles = batch->tiles.get_tile_range(view_low, view_high);
+
+        if (batch->dirty || batch->uploaded_scale != scale || batch->uploaded_tiles != tiles)
+        {
+            upload_circle_batch(*batch, batch_circles, scale, tiles);
+        }
+    }
+
+    if (curve_tiles_dirty)
+    {
+        build_curve_tiles(curves);
+    }
+
+    auto tiles = curve_tiles.get_tile_range(view_low, view_high);
+
+    if (curve_render_mode == CurveRenderMode::Cpu)
+    {
+        if (curves_dirty || curve_segments != tessellated_segments || curve_tolerance != tessellated_tolerance || scale != tessellated_scale || tiles != tessellated_tiles)
+        {
+            upload_curves(curves, scale, tiles);
+        }
+    }
+
+    if (curve_render_mode == CurveRenderMode::Tessellation && (patches_dirty || tiles != patch_tiles))
+    {
+        upload_patches(curves, tiles);
+    }
+
+    // CPU time of submitting the draws, the GPU runs them later
+    ScopedTimer timer(ProfileStage::Draw);
+
+    glUseProgram(circle_program);
+    glUniformMatrix4fv(circle_projection_uniform, 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform1f(circle_pixel_size_uniform, 1.0f / scale);
+
+    if (gpu_timers != nullptr)
+    {
+        gpu_timers->begin(GpuStage::Circles);
+    }
+
+    // Coverage is computed in the fragment shader, edges blend into what is below them
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    render_circle_batch(circle_batch);
+    render_circle_batch(marker_batch);
+
+    glDisable(GL_BLEND);
+
+    if (gpu_timers != nullptr)
+    {
+        gpu_timers->end();
+        gpu_timers->begin(GpuStage::Curves);
+    }
+
+    if (curve_render_mode == CurveRenderMode::Tessellation)
+    {
+        render_curve_patches(projection);
+    }
+    else
+    {
+        render_curve_strips(projection);
+    }
+
+    if (gpu_timers != nullptr)
+    {
+        gpu_timers->end();
+    }
+
+    glBindVertexArray(0);
+}
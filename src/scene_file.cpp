@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <scene_file.hpp>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static uint64_t align_offset(uint64_t offset)
+{
+    return (offset + 15) & ~(uint64_t)15;
+}
+
+static SceneFileHeader get_scene_header(uint64_t circle_count)
+{
+    SceneFileHeader header = {};
+
+    std::memcpy(header.magic, SCENE_FILE_MAGIC, 4);
+    header.version = SCENE_FILE_VERSION;
+    header.circle_count = circle_count;
+    header.positions_offset = align_offset(sizeof(SceneFileHeader));
+    header.radii_offset = align_offset(header.positions_offset + circle_count * 2 * sizeof(float));
+
+    return header;
+}
+
+MappedSceneFile::~MappedSceneFile()
+{
+    close();
+}
+
+bool MappedSceneFile::open(const std::string &path)
+{
+    close();
+
+#ifdef _WIN32
+    file_handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (file_handle == INVALID_HANDLE_VALUE)
+    {
+        file_handle = nullptr;
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file_handle, &file_size);
+    size = file_size.QuadPart;
+
+    mapping_handle = size > 0 ? CreateFileMappingA(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+    data = mapping_handle != nullptr ? MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+#else
+    auto file = ::open(path.c_str(), O_RDONLY);
+
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat file_stat;
+    fstat(file, &file_stat);
+    size = file_stat.st_size;
+
+    data = size > 0 ? mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0) : nullptr;
+
+    if (data == MAP_FAILED)
+    {
+        data = nullptr;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(file);
+
+    if (data != nullptr)
+    {
+        // Skinning walks the arrays front to back
+        madvise(data, size, MADV_SEQUENTIAL);
+    }
+#endif
+
+    if (data == nullptr || size < sizeof(SceneFileHeader))
+    {
+        close();
+        return false;
+    }
+
+    auto header = (const SceneFileHeader *)data;
+    auto expected = get_scene_header(header->circle_count);
+
+    if (std::memcmp(header->magic, SCENE_FILE_MAGIC, 4) != 0
+        || header->version != SCENE_FILE_VERSION
+        || header->circle_count > size / (3 * sizeof(float))
+        || header->positions_offset != expected.positions_offset
+        || header->radii_offset != expected.radii_offset
+        || header->radii_offset + header->circle_count * sizeof(float) > size)
+    {
+        close();
+        return false;
+    }
+
+    positions = std::span((const glm::vec2 *)((const char *)data + header->positions_offset), header->circle_count);
+    radii = std::span((const float *)((const char *)data + header->radii_offset), header->circle_count);
+
+    // The picking grid and the skinning kernels trust the circles, one pass over the mapping
+    // is cheap next to skinning it
+    for (size_t i = 0; i < positions.size(); i++)
+    {
+        if (!std::isfinite(positions[i].x) || !std::isfinite(positions[i].y) || !std::isfinite(radii[i]) || radii[i] <= 0.0f)
+        {
+            close();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void MappedSceneFile::close()
+{
+#ifdef _WIN32
+    if (data != nullptr)
+    {
+        UnmapViewOfFile(data);
+    }
+
+    if (mapping_handle != nullptr)
+    {
+        CloseHandle(mapping_handle);
+    }
+
+    if (file_handle != nullptr)
+    {
+        CloseHandle(file_handle);
+    }
+
+    mapping_handle = nullptr;
+    file_handle = nullptr;
+#else
+    if (data != nullptr)
+    {
+        munmap(data, size);
+    }
+#endif
+
+    data = nullptr;
+    size = 0;
+    positions = {};
+    radii = {};
+}
+
+size_t MappedSceneFile::get_circle_count() const
+{
+    return positions.size();
+}
+
+std::span<const glm::vec2> MappedSceneFile::get_positions() const
+{
+    return positions;
+}
+
+std::span<const float> MappedSceneFile::get_radii() const
+{
+    return radii;
+}
+
+static void write_at(std::ostream &stream, uint64_t offset, const void *data, size_t size)
+{
+    stream.seekp(offset);
+    stream.write((const char *)data, size);
+}
+
+static void write_scene_chunk(std::ostream &stream, const SceneFileHeader &header, size_t first, std::span<const glm::vec2> positions, std::span<const float> radii)
+{
+    write_at(stream, header.positions_offset + first * sizeof(glm::vec2), positions.data(), positions.size_bytes());
+    write_at(stream, header.radii_offset + first * sizeof(float), radii.data(), radii.size_bytes());
+}
+
+bool write_scene_file(const std::string &path, std::span<const SkinCircle> circles)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+    if (!file)
+    {
+        return false;
+    }
+
+    auto header = get_scene_header(circles.size());
+    write_at(file, 0, &header, sizeof(header));
+
+    std::vector<glm::vec2> positions;
+    std::vector<float> radii;
+
+    for (size_t first = 0; first < circles.size(); first += SKIN_FILE_CHUNK_CIRCLES)
+    {
+        auto count = std::min(circles.size() - first, (size_t)SKIN_FILE_CHUNK_CIRCLES);
+
+        positions.clear();
+        radii.clear();
+
+        for (auto &circle : circles.subspan(first, count))
+        {
+            positions.push_back(circle.position);
+            radii.push_back(circle.radius);
+        }
+
+        write_scene_chunk(file, header, first, positions, radii);
+    }
+
+    // An empty radius array still has to end inside the file for open to accept it
+    file.seekp(0, std::ios::end);
+
+    if ((uint64_t)file.tellp() < header.radii_offset)
+    {
+        write_at(file, header.radii_offset - 1, "", 1);
+    }
+
+    return (bool)file;
+}
+
+static bool parse_scene_line(const std::string &line, glm::vec2 &position, float &radius)
+{
+    auto text = line.substr(0, line.find('#'));
+    std::istringstream stream(text);
+
+    return (bool)(stream >> position.x >> position.y >> radius);
+}
+
+bool import_text_scene(const std::string &text_path, const std::string &scene_path)
+{
+    std::ifstream text(text_path);
+
+    if (!text)
+    {
+        return false;
+    }
+
+    // The header needs the count, so the text is read twice instead of held in memory
+    uint64_t circle_count = 0;
+    std::string line;
+    glm::vec2 position;
+    float radius;
+
+    while (std::getline(text, line))
+    {
+        circle_count += parse_scene_line(line, position, radius);
+    }
+
+    text.clear();
+    text.seekg(0);
+
+    std::ofstream file(scene_path, std::ios::binary | std::ios::trunc);
+
+    if (!file)
+    {
+        return false;
+    }
+
+    auto header = get_scene_header(circle_count);
+    write_at(file, 0, &header, sizeof(header));
+
+    std::vector<glm::vec2> positions;
+    std::vector<float> radii;
+    size_t first = 0;
+
+    while (std::getline(text, line))
+    {
+        if (!parse_scene_line(line, position, radius))
+        {
+            continue;
+        }
+
+        positions.push_back(position);
+        radii.push_back(radius);
+
+        if (positions.size() == SKIN_FILE_CHUNK_CIRCLES)
+        {
+            write_scene_chunk(file, header, first, positions, radii);
+            first += positions.size();
+            positions.clear();
+            radii.clear();
+        }
+    }
+
+    write_scene_chunk(file, header, first, positions, radii);
+
+    file.seekp(0, std::ios::end);
+
+    if ((uint64_t)file.tellp() < header.radii_offset)
+    {
+        write_at(file, header.radii_offset - 1, "", 1);
+    }
+
+    return (bool)file;
+}
+
+bool is_scene_file(const std::string &path)
+{
+    std::ifstream file(path, std::ios::binary);
+    char magic[4] = {};
+
+    file.read(magic, 4);
+
+    return file && std::memcmp(magic, SCENE_FILE_MAGIC, 4) == 0;
+}
+
+static void append_curve(std::vector<float> &data, const HermiteCurve &curve)
+{
+    for (auto point : { curve.get_p0(), curve.get_p1(), curve.get_v0(), curve.get_v1() })
+    {
+        data.push_back(point.x);
+        data.push_back(point.y);
+    }
+}
+
+bool skin_scene_file(const MappedSceneFile &scene, const std::string &output_path, size_t chunk_circles, bool mixed_precision)
+{
+    auto circle_count = scene.get_circle_count();
+
+    if (circle_count < 2 || chunk_circles == 0)
+    {
+        return false;
+    }
+
+    std::ofstream file(output_path, std::ios::binary | std::ios::trunc);
+
+    if (!file)
+    {
+        return false;
+    }
+
+    auto curve_count = circle_count - 1;
+
+    SkinFileHeader header = {};
+    std::memcpy(header.magic, SKIN_FILE_MAGIC, 4);
+    header.version = SCENE_FILE_VERSION;
+    header.circle_count = circle_count;
+    header.left_points_offset = align_offset(sizeof(SkinFileHeader));
+    header.right_points_offset = align_offset(header.left_points_offset + circle_count * sizeof(glm::vec2));
+    header.left_curves_offset = align_offset(header.right_points_offset + circle_count * sizeof(glm::vec2));
+    header.right_curves_offset = align_offset(header.left_curves_offset + curve_count * 8 * sizeof(float));
+
+    write_at(file, 0, &header, sizeof(header));
+
+    auto positions = scene.get_positions();
+    auto radii = scene.get_radii();
+
+    std::vector<SkinCircle> circles;
+    SkinStorage skin;
+    SkinningContext context;
+    std::vector<float> left_curves;
+    std::vector<float> right_curves;
+
+    for (size_t first = 0; first < circle_count; first += chunk_circles)
+    {
+        auto last = std::min(first + chunk_circles, circle_count) - 1;
+
+        // Points depend on the neighbours on both sides, and the last curve of the chunk on the
+        // point after it, so the chunk is skinned with one circle before and two after it. The
+        // extra circles are treated as chain ends here and their results are dropped.
+        auto span_first = first > 0 ? first - 1 : 0;
+        auto span_last = std::min(last + 2, circle_count - 1);
+
+        circles.clear();
+
+        for (auto i = span_first; i <= span_last; i++)
+        {
+            circles.push_back(SkinCircle{positions[i], radii[i]});
+        }
+
+        skin.resize(circles.size());
+
+        if (mixed_precision)
+        {
+            context.calculate_skin<MixedPrecision>(circles, skin.get_buffers());
+        }
+        else
+        {
+            context.calculate_skin<FloatPrecision>(circles, skin.get_buffers());
+        }
+
+        auto offset = first - span_first;
+        auto count = last - first + 1;
+        auto chunk_curves = std::min(count, curve_count - first);
+        auto span_curves = circles.size() - 1;
+
+        write_at(file, header.left_points_offset + first * sizeof(glm::vec2), &skin.left_points[offset], count * sizeof(glm::vec2));
+        write_at(file, header.right_points_offset + first * sizeof(glm::vec2), &skin.right_points[offset], count * sizeof(glm::vec2));
+
+        left_curves.clear();
+        right_curves.clear();
+
+        for (size_t i = 0; i < chunk_curves; i++)
+        {
+            append_curve(left_curves, skin.curves[offset + i]);
+            append_curve(right_curves, skin.curves[span_curves + offset + i]);
+        }
+
+        write_at(file, header.left_curves_offset + first * 8 * sizeof(float), left_curves.data(), left_curves.size() * sizeof(float));
+        write_at(file, header.right_curves_offset + first * 8 * sizeof(float), right_curves.data(), right_curves.size() * sizeof(float));
+
+        if (!file)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
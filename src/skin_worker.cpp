@@ -0,0 +1,261 @@
+#include <algorithm>
+#include <skin_worker.hpp>
+
+SkinWorker::~SkinWorker()
+{
+    stop();
+}
+
+void SkinWorker::start()
+{
+    if (thread.joinable())
+    {
+        return;
+    }
+
+    stopping = false;
+    // Results of an earlier run may belong to other circles, the first one of this run is full
+    scene_valid = false;
+
+    while (results.acquire() != nullptr)
+    {
+    }
+
+    scene.thread_pool = thread_pool;
+    // Read before the thread exists, a snapshot submitted before the thread got to it would
+    // otherwise look already seen and wait for the next one
+    thread = std::thread(&SkinWorker::worker_loop, this, submitted_generation.load(std::memory_order_acquire));
+}
+
+void SkinWorker::stop()
+{
+    if (!thread.joinable())
+    {
+        return;
+    }
+
+    stopping = true;
+    submitted_generation.fetch_add(1, std::memory_order_release);
+    submitted_generation.notify_one();
+    thread.join();
+}
+
+bool SkinWorker::is_running() const
+{
+    return thread.joinable();
+}
+
+uint32_t SkinWorker::submit(std::span<const SkinCircle> circles, std::span<const size_t> chain_starts)
+{
+    auto &input = inputs.get_write_slot();
+    auto generation = submitted_generation.load(std::memory_order_relaxed) + 1;
+
+    input.circles.assign(circles.begin(), circles.end());
+    input.chain_starts.assign(chain_starts.begin(), chain_starts.end());
+    input.generation = generation;
+    inputs.publish();
+
+    submitted_generation.store(generation, std::memory_order_release);
+    submitted_generation.notify_one();
+
+    return generation;
+}
+
+const SkinResult *SkinWorker::acquire_result()
+{
+    auto result = results.acquire();
+
+    if (result != nullptr)
+    {
+        acquired_pass.store(result->pass, std::memory_order_release);
+    }
+
+    return result;
+}
+
+void SkinWorker::worker_loop(uint32_t seen_generation)
+{
+    while (true)
+    {
+        submitted_generation.wait(seen_generation, std::memory_order_acquire);
+        seen_generation = submitted_generation.load(std::memory_order_acquire);
+
+        if (stopping)
+        {
+            return;
+        }
+
+        auto input = inputs.acquire();
+
+        if (input == nullptr)
+        {
+            continue;
+        }
+
+        pass++;
+
+        if (calculate(*input))
+        {
+            add_pending_ranges();
+        }
+        else
+        {
+            full_pass = pass;
+        }
+
+        auto &result = results.get_write_slot();
+
+        result.generation = input->generation;
+        result.pass = pass;
+        result.circle_count = input->circles.size();
+        result.chain_starts = input->chain_starts;
+        result.closed_form_fallbacks = scene.get_closed_form_fallbacks();
+        fill_result(result);
+        results.publish();
+
+        if (result_callback != nullptr)
+        {
+            result_callback();
+        }
+    }
+}
+
+bool SkinWorker::calculate(const SkinInput &input)
+{
+    auto &circles = input.circles;
+    auto chain_starts = scene.get_chain_starts();
+
+    // Snapshots carry no dirty ranges, since skipped ones would lose theirs. Comparing against
+    // the previous snapshot finds the changed circles instead, which is cheap next to skinning,
+    // and only the chains holding them are skinned again.
+    auto same_chains = scene_valid && std::equal(chain_starts.begin(), chain_starts.end(), input.chain_starts.begin(), input.chain_starts.end());
+
+    if (same_chains)
+    {
+        auto skinned_circles = scene.get_circles();
+
+        for (size_t i = 0; i < circles.size(); i++)
+        {
+            if (circles[i].position != skinned_circles[i].position || circles[i].radius != skinned_circles[i].radius)
+            {
+                scene.set_circle(i, circles[i]);
+            }
+        }
+    }
+    else
+    {
+        scene.assign(circles, input.chain_starts);
+        scene_valid = true;
+    }
+
+    scene.update_skins();
+
+    return same_chains;
+}
+
+void SkinWorker::add_pending_ranges()
+{
+    auto chain_starts = scene.get_chain_starts();
+    auto curve_starts = scene.get_curve_starts();
+
+    for (auto chain : scene.get_updated_chains())
+    {
+        auto window = scene.get_updated_window(chain);
+        auto curve_count = (curve_starts[chain + 1] - curve_starts[chain]) / 2;
+
+        if (window.first_point <= window.last_point)
+        {
+            pending_point_ranges.push_back({pass, SkinRange{chain_starts[chain] + window.first_point, chain_starts[chain] + window.last_point}});
+        }
+
+        // Left curves of the chain first, then the right ones
+        if (window.first_curve <= window.last_curve)
+        {
+            pending_curve_ranges.push_back({pass, SkinRange{curve_starts[chain] + window.first_curve, curve_starts[chain] + window.last_curve}});
+            pending_curve_ranges.push_back({pass, SkinRange{curve_starts[chain] + curve_count + window.first_curve, curve_starts[chain] + curve_count + window.last_curve}});
+        }
+    }
+}
+
+// Merges ranges sorted by their first index into as few ranges as possible
+static void merge_ranges(std::vector<SkinRange> &ranges)
+{
+    std::sort(ranges.begin(), ranges.end(), [](const SkinRange &a, const SkinRange &b) { return a.first < b.first; });
+
+    size_t merged = 0;
+
+    for (auto &range : ranges)
+    {
+        if (merged > 0 && range.first <= ranges[merged - 1].last + 1)
+        {
+            ranges[merged - 1].last = std::max(ranges[merged - 1].last, range.last);
+        }
+        else
+        {
+            ranges[merged++] = range;
+        }
+    }
+
+    ranges.resize(merged);
+}
+
+void SkinWorker::fill_result(SkinResult &result)
+{
+    auto acquired = acquired_pass.load(std::memory_order_acquire);
+    auto is_seen = [&](const std::pair<uint64_t, SkinRange> &range) { return range.first <= acquired; };
+
+    // The render thread already applied these, or a full skin replacing them
+    std::erase_if(pending_point_ranges, is_seen);
+    std::erase_if(pending_curve_ranges, is_seen);
+
+    // A render thread that stopped picking up results would let the ranges pile up
+    if (pending_point_ranges.size() + pending_curve_ranges.size() > SKIN_WORKER_MAX_PENDING_RANGES)
+    {
+        full_pass = pass;
+    }
+
+    auto &skin = scene.get_skin();
+
+    result.point_ranges.clear();
+    result.curve_ranges.clear();
+    result.full = full_pass > acquired;
+
+    if (result.full)
+    {
+        pending_point_ranges.clear();
+        pending_curve_ranges.clear();
+
+        result.skin.left_points = skin.left_points;
+        result.skin.right_points = skin.right_points;
+        result.skin.curves = skin.curves;
+        return;
+    }
+
+    for (auto &range : pending_point_ranges)
+    {
+        result.point_ranges.push_back(range.second);
+    }
+
+    for (auto &range : pending_curve_ranges)
+    {
+        result.curve_ranges.push_back(range.second);
+    }
+
+    merge_ranges(result.point_ranges);
+    merge_ranges(result.curve_ranges);
+
+    result.skin.left_points.clear();
+    result.skin.right_points.clear();
+    result.skin.curves.clear();
+
+    for (auto &range : result.point_ranges)
+    {
+        result.skin.left_points.insert(result.skin.left_points.end(), skin.left_points.begin() + range.first, skin.left_points.begin() + range.last + 1);
+        result.skin.right_points.insert(result.skin.right_points.end(), skin.right_points.begin() + range.first, skin.right_points.begin() + range.last + 1);
+    }
+
+    for (auto &range : result.curve_ranges)
+    {
+        result.skin.curves.insert(result.skin.curves.end(), skin.curves.begin() + range.first, skin.curves.begin() + range.last + 1);
+    }
+}
@@ -0,0 +1,895 @@
+#include <cmath>
+#include <profiler.hpp>
+#include <skinning.hpp>
+#include <thread_pool.hpp>
+#include <touching_circle_kernel.hpp>
+#include <type_traits>
+
+glm::vec2 HermiteCurve::hermite(glm::vec2 p_cur, glm::vec2 p_next, glm::vec2 v_cur, glm::vec2 v_next, float t) const
+{
+    float h0 = 2 * glm::pow(t, 3) - 3 * glm::pow(t, 2) + 1;
+    float h1 = -2 * glm::pow(t, 3) + 3 * glm::pow(t, 2);
+    float h2 = glm::pow(t, 3) - 2 * glm::pow(t, 2) + t;
+    float h3 = glm::pow(t, 3) - glm::pow(t, 2);
+
+    return h0 * p_cur + h1 * p_next + h2 * v_cur + h3 * v_next;
+}
+
+HermiteCurve::HermiteCurve(glm::vec2 p0, glm::vec2 p1, glm::vec2 v0, glm::vec2 v1, glm::vec3 color)
+{
+    this->p0 = p0;
+    this->p1 = p1;
+    this->v0 = v0;
+    this->v1 = v1;
+    this->color = color;
+}
+
+std::vector<float> HermiteCurve::get_vertex_data(int segments) const
+{
+    std::vector<float> data;
+
+    append_vertex_data(data, segments);
+
+    return data;
+}
+
+void HermiteCurve::append_vertex_data(std::vector<float> &data, int segments) const
+{
+    for (int i = 0; i <= segments; i++)
+    {
+        float t0 = (float)i / (float)segments;
+
+        auto point = hermite(p0, p1, v0, v1, t0);
+
+        data.push_back(point.x);
+        data.push_back(point.y);
+        data.push_back(color.x);
+        data.push_back(color.y);
+        data.push_back(color.z);
+    }
+}
+
+void HermiteCurve::append_points(std::vector<glm::vec2> &points, int segments) const
+{
+    for (int i = 0; i <= segments; i++)
+    {
+        float t0 = (float)i / (float)segments;
+
+        points.push_back(hermite(p0, p1, v0, v1, t0));
+    }
+}
+
+glm::vec2 HermiteCurve::get_p0() const
+{
+    return p0;
+}
+
+glm::vec2 HermiteCurve::get_p1() const
+{
+    return p1;
+}
+
+glm::vec2 HermiteCurve::get_v0() const
+{
+    return v0;
+}
+
+glm::vec2 HermiteCurve::get_v1() const
+{
+    return v1;
+}
+
+glm::vec3 HermiteCurve::get_color() const
+{
+    return color;
+}
+
+void HermiteCurve::get_bounds(glm::vec2 &low, glm::vec2 &high) const
+{
+    auto b1 = p0 + v0 / 3.0f;
+    auto b2 = p1 - v1 / 3.0f;
+
+    low = glm::min(glm::min(p0, b1), glm::min(b2, p1));
+    high = glm::max(glm::max(p0, b1), glm::max(b2, p1));
+}
+
+// Wang's formula on the equivalent cubic Bezier curve: n segments stay within
+// sqrt(3 / 4 * M / n^2) of the curve, where M bounds the second differences of the control points.
+int HermiteCurve::get_segment_count(float tolerance, float scale) const
+{
+    auto b0 = p0;
+    auto b1 = p0 + v0 / 3.0f;
+    auto b2 = p1 - v1 / 3.0f;
+    auto b3 = p1;
+
+    auto m = glm::max(glm::length(b2 - 2.0f * b1 + b0), glm::length(b3 - 2.0f * b2 + b1)) * scale;
+
+    auto segments = glm::ceil(glm::sqrt(0.75f * m / tolerance));
+
+    return (int)glm::clamp(segments, 1.0f, (float)MAX_CURVE_SEGMENTS);
+}
+
+size_t skin_point_count(size_t circle_count)
+{
+    return circle_count < 2 ? 0 : circle_count;
+}
+
+size_t skin_curve_count(size_t circle_count)
+{
+    return circle_count < 2 ? 0 : 2 * (circle_count - 1);
+}
+
+// A skin point depends on its own circle and both neighbours, a curve on the two circles and
+// the two skin points at its ends, so an edit reaches one point and two curves further out.
+SkinWindow get_skin_window(size_t circle_count, size_t first_circle, size_t last_circle)
+{
+    if (circle_count < 2 || first_circle > last_circle)
+    {
+        return SkinWindow{1, 0, 1, 0};
+    }
+
+    last_circle = glm::min(last_circle, circle_count - 1);
+
+    SkinWindow window;
+    window.first_point = first_circle < 1 ? 0 : first_circle - 1;
+    window.last_point = glm::min(last_circle + 1, circle_count - 1);
+    window.first_curve = first_circle < 2 ? 0 : first_circle - 2;
+    window.last_curve = glm::min(last_circle + 1, circle_count - 2);
+
+    return window;
+}
+
+// Based on: https://math.stackexchange.com/questions/3100828/calculate-the-circle-that-touches-three-other-circles
+template <typename Precision>
+std::optional<BasicTouchingCircle<typename Precision::storage_type>> find_touching_circle(
+    const BasicSkinCircle<typename Precision::storage_type> &c1,
+    const BasicSkinCircle<typename Precision::storage_type> &c2,
+    const BasicSkinCircle<typename Precision::storage_type> &c3,
+    int s1, int s2, int s3)
+{
+    using T = typename Precision::compute_type;
+    using S = typename Precision::storage_type;
+
+    T r1 = s1 * (T)c1.radius;
+    T r2 = s2 * (T)c2.radius;
+    T r3 = s3 * (T)c3.radius;
+
+    T x1 = c1.position.x;
+    T y1 = c1.position.y;
+    T x2 = c2.position.x;
+    T y2 = c2.position.y;
+    T x3 = c3.position.x;
+    T y3 = c3.position.y;
+
+    T k_a = -r1 * r1 + r2 * r2 + x1 * x1 - x2 * x2 + y1 * y1 - y2 * y2;
+    T k_b = -r1 * r1 + r3 * r3 + x1 * x1 - x3 * x3 + y1 * y1 - y3 * y3;
+
+    T d = x1 * (y2 - y3) + x2 * (y3 - y1) + x3 * (y1 - y2);
+    T a0 = (k_a * (y1 - y3) + k_b * (y2 - y1)) / (2 * d);
+    T b0 = -(k_a * (x1 - x3) + k_b * (x2 - x1)) / (2 * d);
+
+    T a1 = -(r1 * (y2 - y3) + r2 * (y3 - y1) + r3 * (y1 - y2)) / d;
+    T b1 = (r1 * (x2 - x3) + r2 * (x3 - x1) + r3 * (x1 - x2)) / d;
+
+    // T C0 = glm::pow(a0 - x1, 2) + glm::pow(b0 - y1, 2) - glm::pow(r1, 2);
+    T C0 = a0 * a0 - 2 * a0 * x1 + b0 * b0 - 2 * b0 * y1 - r1 * r1 + x1 * x1 + y1 * y1;
+    // T C1 = a1 * (a0 - x1) + b1 * (b0 - y1) - r1;
+    T C1 = a0 * a1 - a1 * x1 + b0 * b1 - b1 * y1 - r1;
+    T C2 = a1 * a1 + b1 * b1 - 1;
+
+    auto root_inner = C1 * C1 - C0 * C2;
+
+    if (root_inner < 0)
+    {
+        return std::nullopt;
+    }
+
+    T r = (-glm::sqrt(root_inner) - C1)/ C2;
+
+    T x = a0 + a1 * r;
+    T y = b0 + b1 * r;
+
+    return BasicTouchingCircle<S>{(S)r, glm::vec<2, S>((S)x, (S)y)};
+}
+
+CircleExternalTangentPoints get_tangent_points(glm::vec2 c1_pos, float r1, glm::vec2 c2_pos, float r2)
+{
+    auto d = c2_pos - c1_pos;
+    auto l = glm::length(d);
+    auto u = d / l;
+    auto v = glm::vec2(-d.y / l, d.x / l);
+
+    auto p1 = c1_pos + r1 * ((r2 - r1) * u + l * v) / l;
+    auto p2 = c2_pos + r2 * ((r2 - r1) * u + l * v) / l;
+    auto p3 = c1_pos + r1 * ((r2 - r1) * u + l * -1 * v) / l;
+    auto p4 = c2_pos + r2 * ((r2 - r1) * u + l * -1 * v) / l;
+
+    return CircleExternalTangentPoints{p1, p2, p3, p4};
+}
+
+bool get_if_circles_touch_externally_or_internally(glm::vec2 common_circle_pos, float common_circle_radius, glm::vec2 circle_pos, float circle_radius)
+{
+    auto distance = glm::distance(circle_pos, common_circle_pos);
+    auto radius_diff = glm::abs(circle_radius - common_circle_radius);
+
+    if (glm::abs(distance - radius_diff) < 0.1f)
+    {
+        // Circles touch internally
+        return true;
+    }
+
+    // Circles touch externally (no need for further checks, since the circles are guaranteed to touch)
+    return false;
+}
+
+static std::tuple<glm::vec2, glm::vec2> get_fallback_curve_points(std::span<const SkinCircle> circles, int index)
+{
+    auto tangent_points = get_tangent_points(
+        circles[index].position, circles[index].radius,
+        circles[index + 1].position, circles[index + 1].radius);
+
+    return std::make_tuple(tangent_points.c1_p1, tangent_points.c1_p2);
+}
+
+std::tuple<glm::vec2, glm::vec2> select_curve_points(std::span<const SkinCircle> circles, int index, std::span<const std::optional<TouchingCircle>> touching_circles)
+{
+    glm::vec2 curve_points[2];
+    int curve_point_count = 0;
+
+    for (auto &touching_circle : touching_circles)
+    {
+        if (!touching_circle)
+        {
+            return get_fallback_curve_points(circles, index);
+        }
+
+        auto touching_point = touching_circle->position + glm::normalize(circles[index].position - touching_circle->position) * touching_circle->radius;
+
+        auto control_orientation = get_if_circles_touch_externally_or_internally(touching_circle->position, touching_circle->radius, circles[index].position, circles[index].radius);
+
+        auto all_same_orientation = true;
+
+        for (auto circle : { &circles[index - 1], &circles[index + 1] })
+        {
+            auto orientation = get_if_circles_touch_externally_or_internally(touching_circle->position, touching_circle->radius, circle->position, circle->radius);
+
+            if (orientation != control_orientation)
+            {
+                all_same_orientation = false;
+                break;
+            }
+        }
+
+        if (all_same_orientation && curve_point_count < 2)
+        {
+            curve_points[curve_point_count++] = touching_point;
+        }
+    }
+
+    if (curve_point_count < 2)
+    {
+        return get_fallback_curve_points(circles, index);
+    }
+
+    return std::make_tuple(curve_points[0], curve_points[1]);
+}
+
+// Point where a touching circle found with the sign s for every circle touches the circle, or
+// nullopt when the solve broke down. The circle is at distance |r + s * R| from the touching
+// circle, touched from outside when s * (r + s * R) is positive and from inside otherwise.
+// Stepping R from the centre of the circle instead of r from the touching circle keeps the
+// point on the circle even for the huge touching circles of nearly collinear triples.
+static std::optional<glm::vec2> get_closed_form_touching_point(const SkinCircle &circle, const TouchingCircle &touching_circle, float s)
+{
+    // Collinear centres divide by zero and come out of the solve as NaN or infinity
+    if (!std::isfinite(touching_circle.radius) || !std::isfinite(touching_circle.position.x) || !std::isfinite(touching_circle.position.y))
+    {
+        return std::nullopt;
+    }
+
+    auto signed_distance = touching_circle.radius + s * circle.radius;
+
+    if (glm::abs(signed_distance) < CLOSED_FORM_MIN_DISTANCE)
+    {
+        return std::nullopt;
+    }
+
+    auto direction = glm::normalize(touching_circle.position - circle.position);
+
+    return circle.position + direction * (s * signed_distance > 0 ? circle.radius : -circle.radius);
+}
+
+// With equal signs every circle of the triple is at distance |r + s * R| from the touching
+// circle, so all three touch it the same way. Mixed signs touch one circle the other way and
+// only pass the orientation check of the search when the float error of the solve exceeds its
+// tolerance.
+std::optional<std::tuple<glm::vec2, glm::vec2>> select_closed_form_curve_points(std::span<const SkinCircle> circles, int index, const std::optional<TouchingCircle> &outer, const std::optional<TouchingCircle> &inner)
+{
+    // The search gives up on the first missing solution as well
+    if (!outer || !inner)
+    {
+        return get_fallback_curve_points(circles, index);
+    }
+
+    auto outer_point = get_closed_form_touching_point(circles[index], *outer, 1.0f);
+    auto inner_point = get_closed_form_touching_point(circles[index], *inner, -1.0f);
+
+    if (!outer_point || !inner_point)
+    {
+        return std::nullopt;
+    }
+
+    return std::make_tuple(*outer_point, *inner_point);
+}
+
+template <typename Precision>
+std::tuple<glm::vec2, glm::vec2> search_curve_points_for_circle(std::span<const SkinCircle> circles, int index)
+{
+    std::optional<TouchingCircle> touching_circles[TOUCHING_CIRCLE_COMBINATIONS];
+
+    for (auto k = 0; k < TOUCHING_CIRCLE_COMBINATIONS; k++)
+    {
+        touching_circles[k] = find_touching_circle<Precision>(
+            circles[index - 1], circles[index], circles[index + 1],
+            k & 1 ? -1 : 1, k & 2 ? -1 : 1, k & 4 ? -1 : 1);
+    }
+
+    return select_curve_points(circles, index, touching_circles);
+}
+
+template <typename Precision>
+std::tuple<glm::vec2, glm::vec2> find_curve_points_for_circle(std::span<const SkinCircle> circles, int index)
+{
+    auto outer = find_touching_circle<Precision>(circles[index - 1], circles[index], circles[index + 1], 1, 1, 1);
+    auto inner = find_touching_circle<Precision>(circles[index - 1], circles[index], circles[index + 1], -1, -1, -1);
+
+    auto points = select_closed_form_curve_points(circles, index, outer, inner);
+
+    if (points)
+    {
+        return *points;
+    }
+
+    return search_curve_points_for_circle<Precision>(circles, index);
+}
+
+// The geometry below is written once on the compute type. The public templates convert their
+// arguments to it, so the float policy runs exactly the float arithmetic it always did.
+template <typename T>
+static BasicRadicalLine<T> get_radical_line_of(glm::vec<2, T> c1_pos, T r1, glm::vec<2, T> c2_pos, T r2)
+{
+    T a = 2 * (c2_pos.x - c1_pos.x);
+    T b = 2 * (c2_pos.y - c1_pos.y);
+    // T c = (glm::pow(c1_pos.x, 2) + glm::pow(c2_pos.x, 2)) - (glm::pow(c1_pos.y, 2) + glm::pow(c2_pos.y, 2)) - (glm::pow(r1, 2) + glm::pow(r2, 2));
+    T c = (glm::pow(c1_pos.x, 2) - glm::pow(c2_pos.x, 2)) + (glm::pow(c1_pos.y, 2) - glm::pow(c2_pos.y, 2)) - (glm::pow(r1, 2) + glm::pow(r2, 2));
+
+    return BasicRadicalLine<T>{a, b, c};
+}
+
+template <typename T>
+static glm::vec<2, T> find_radical_center_of(glm::vec<2, T> c1_pos, T r1, glm::vec<2, T> c2_pos, T r2, glm::vec<2, T> c3_pos, T r3)
+{
+    auto radical_line1 = get_radical_line_of(c1_pos, r1, c2_pos, r2);
+    auto radical_line2 = get_radical_line_of(c2_pos, r1, c3_pos, r3);
+
+    T a1 = radical_line1.a;
+    T b1 = radical_line1.b;
+    T c1 = radical_line1.c * -1;
+
+    T a2 = radical_line2.a;
+    T b2 = radical_line2.b;
+    T c2 = radical_line2.c * -1;
+
+    T d = a1 * b2 - a2 * b1;
+
+    T x = (c1 * b2 - c2 * b1) / d;
+    T y = (a1 * c2 - a2 * c1) / d;
+
+    return glm::vec<2, T>(x, y);
+}
+
+template <typename T>
+static glm::vec<2, T> rotate_vector_of(glm::vec<2, T> vec, T angle)
+{
+    T rad = glm::radians(angle);
+
+    T cos = glm::cos(rad);
+    T sin = glm::sin(rad);
+
+    // The product of glm::mat2x2(cos, -sin, sin, cos) and vec, spelled out for any scalar type
+    return glm::vec<2, T>(cos * vec.x + sin * vec.y, -sin * vec.x + cos * vec.y);
+}
+
+template <typename T>
+static glm::vec<2, T> flip_when_facing_opposite_of(glm::vec<2, T> vec, glm::vec<2, T> check_against)
+{
+    T dot = vec.x * check_against.x + vec.y * check_against.y;
+    T det = vec.x * check_against.y - vec.y * check_against.x;
+
+    T angle = glm::atan(det, dot);
+
+    if (glm::abs(angle) > glm::radians((T)90))
+    {
+        return -vec;
+    }
+
+    return vec;
+}
+
+template <typename T>
+static std::tuple<glm::vec<2, T>, glm::vec<2, T>> calculate_tangents_of(glm::vec<2, T> c1_pos, T r1, glm::vec<2, T> c2_pos, T r2, glm::vec<2, T> point1, glm::vec<2, T> point2)
+{
+    auto radical_line = get_radical_line_of(c1_pos, r1, c2_pos, r2);
+
+    T radical_distance_a = (glm::abs(radical_line.a * point1.x + radical_line.b * point1.y + radical_line.c)) / glm::sqrt(glm::pow(radical_line.a, 2) + glm::pow(radical_line.b, 2));
+    T radical_distance_b = (glm::abs(radical_line.a * point2.x + radical_line.b * point2.y + radical_line.c)) / glm::sqrt(glm::pow(radical_line.a, 2) + glm::pow(radical_line.b, 2));
+
+    auto p1_to_c1_vec = (c1_pos - point1) / glm::length(c1_pos - point1);
+    auto p2_to_c2_vec = (c2_pos - point2) / glm::length(c2_pos - point2);
+
+    auto p1_to_p2_vec = point2 - point1;
+
+    auto tangent1 = flip_when_facing_opposite_of(rotate_vector_of(p1_to_c1_vec, (T)-90) * (T)2 * radical_distance_a, p1_to_p2_vec);
+    auto tangent2 = flip_when_facing_opposite_of(rotate_vector_of(p2_to_c2_vec, (T)-90) * (T)2 * radical_distance_b, p1_to_p2_vec);
+
+    return std::make_tuple(tangent1, tangent2);
+}
+
+template <typename Precision>
+BasicRadicalLine<typename Precision::storage_type> get_radical_line(
+    typename Precision::storage_vec2 c1_pos, typename Precision::storage_type r1,
+    typename Precision::storage_vec2 c2_pos, typename Precision::storage_type r2)
+{
+    using T = typename Precision::compute_type;
+    using V = typename Precision::compute_vec2;
+    using S = typename Precision::storage_type;
+
+    auto line = get_radical_line_of(V(c1_pos), (T)r1, V(c2_pos), (T)r2);
+
+    return BasicRadicalLine<S>{(S)line.a, (S)line.b, (S)line.c};
+}
+
+template <typename Precision>
+typename Precision::storage_vec2 find_radical_center(
+    typename Precision::storage_vec2 c1_pos, typename Precision::storage_type r1,
+    typename Precision::storage_vec2 c2_pos, typename Precision::storage_type r2,
+    typename Precision::storage_vec2 c3_pos, typename Precision::storage_type r3)
+{
+    using T = typename Precision::compute_type;
+    using V = typename Precision::compute_vec2;
+
+    return typename Precision::storage_vec2(find_radical_center_of(V(c1_pos), (T)r1, V(c2_pos), (T)r2, V(c3_pos), (T)r3));
+}
+
+glm::vec2 rotate_vector(glm::vec2 vec, float angle)
+{
+    return rotate_vector_of(vec, angle);
+}
+
+glm::vec2 flip_when_facing_opposite(glm::vec2 vec, glm::vec2 check_against)
+{
+    return flip_when_facing_opposite_of(vec, check_against);
+}
+
+template <typename Precision>
+std::tuple<typename Precision::storage_vec2, typename Precision::storage_vec2> calculate_tangents(
+    typename Precision::storage_vec2 c1_pos, typename Precision::storage_type r1,
+    typename Precision::storage_vec2 c2_pos, typename Precision::storage_type r2,
+    typename Precision::storage_vec2 point1, typename Precision::storage_vec2 point2)
+{
+    using T = typename Precision::compute_type;
+    using V = typename Precision::compute_vec2;
+    using W = typename Precision::storage_vec2;
+
+    auto tangents = calculate_tangents_of(V(c1_pos), (T)r1, V(c2_pos), (T)r2, V(point1), V(point2));
+
+    return std::make_tuple(W(std::get<0>(tangents)), W(std::get<1>(tangents)));
+}
+
+template <typename Precision>
+SeparatedPoints separate_points(glm::vec2 point1, glm::vec2 point2, std::span<const SkinCircle> circles, int index)
+{
+    using T = typename Precision::compute_type;
+    using V = typename Precision::compute_vec2;
+
+    auto radical_center = find_radical_center_of(
+        V(circles[index].position), (T)circles[index].radius,
+        V(circles[index - 1].position), (T)circles[index - 1].radius,
+        V(circles[index + 1].position), (T)circles[index + 1].radius);
+
+    V to_check = V(circles[index].position) - V(circles[index - 1].position);
+    V check_against = V(circles[index + 1].position) - V(circles[index - 1].position);
+
+    T dot = to_check.x * check_against.x + to_check.y * check_against.y;
+    T det = to_check.x * check_against.y - to_check.y * check_against.x;
+
+    T angle = glm::atan(det, dot);
+
+    auto p1_radical_distance = glm::distance(radical_center, V(point1));
+    auto p2_radical_distance = glm::distance(radical_center, V(point2));
+
+    glm::vec2 left;
+    glm::vec2 right;
+
+    if (angle < 0)
+    {
+        if (p1_radical_distance < p2_radical_distance)
+        {
+            left = (point1);
+            right = (point2);
+        }
+        else
+        {
+            left = (point2);
+            right = (point1);
+        }
+    }
+    else
+    {
+        if (p1_radical_distance < p2_radical_distance)
+        {
+            left = (point2);
+            right = (point1);
+        }
+        else
+        {
+            left = (point1);
+            right = (point2);
+        }
+    }
+
+    return SeparatedPoints{left, right };
+}
+
+// The end circles have no neighbour on one side, so the points are separated by which side
+// of the chain direction they fall on. This matches the orientation separate_points produces.
+SeparatedPoints separate_end_points(glm::vec2 point1, glm::vec2 point2, glm::vec2 chain_from, glm::vec2 chain_to)
+{
+    auto direction = chain_to - chain_from;
+    auto to_point = point1 - chain_from;
+
+    float det = direction.x * to_point.y - direction.y * to_point.x;
+
+    if (det < 0)
+    {
+        return SeparatedPoints{point1, point2};
+    }
+
+    return SeparatedPoints{point2, point1};
+}
+
+template <typename Precision>
+void SkinningContext::calculate_interior_points(std::span<const SkinCircle> circles, const SkinBuffers &output, int first, int last, SkinScratch &scratch)
+{
+    size_t count = last - first + 1;
+    size_t solutions = TOUCHING_CIRCLE_PAIR * count;
+
+    scratch.touching_x.resize(solutions);
+    scratch.touching_y.resize(solutions);
+    scratch.touching_radius.resize(solutions);
+    scratch.touching_valid.resize(solutions);
+
+    if constexpr (!std::is_same_v<Precision, FloatPrecision>)
+    {
+        ScopedTimer timer(ProfileStage::TouchingCircles);
+
+        // Stored the way the kernel stores them, the solutions are float in both policies
+        for (auto i = first; i <= last; i++)
+        {
+            size_t solution = i - first;
+
+            for (auto k = 0; k < TOUCHING_CIRCLE_PAIR; k++, solution += count)
+            {
+                auto sign = k == 0 ? 1 : -1;
+                auto touching_circle = find_touching_circle<Precision>(circles[i - 1], circles[i], circles[i + 1], sign, sign, sign);
+
+                scratch.touching_valid[solution] = touching_circle.has_value();
+
+                if (touching_circle)
+                {
+                    scratch.touching_x[solution] = touching_circle->position.x;
+                    scratch.touching_y[solution] = touching_circle->position.y;
+                    scratch.touching_radius[solution] = touching_circle->radius;
+                }
+            }
+        }
+    }
+    else
+    {
+        scratch.soa_x.resize(count + 2);
+        scratch.soa_y.resize(count + 2);
+        scratch.soa_radius.resize(count + 2);
+
+        for (size_t i = 0; i < count + 2; i++)
+        {
+            auto &circle = circles[first - 1 + i];
+
+            scratch.soa_x[i] = circle.position.x;
+            scratch.soa_y[i] = circle.position.y;
+            scratch.soa_radius[i] = circle.radius;
+        }
+
+        ScopedTimer timer(ProfileStage::TouchingCircles);
+
+        find_touching_circles(
+            kernel_isa, scratch.soa_x, scratch.soa_y, scratch.soa_radius, 1, count,
+            TouchingCircleArrays{scratch.touching_x, scratch.touching_y, scratch.touching_radius, scratch.touching_valid});
+    }
+
+    ScopedTimer timer(ProfileStage::Separation);
+
+    for (auto i = first; i <= last; i++)
+    {
+        size_t solution = i - first;
+
+        std::optional<TouchingCircle> touching_circles[TOUCHING_CIRCLE_PAIR];
+
+        for (auto k = 0; k < TOUCHING_CIRCLE_PAIR; k++, solution += count)
+        {
+            if (scratch.touching_valid[solution])
+            {
+                touching_circles[k] = TouchingCircle{scratch.touching_radius[solution], glm::vec2(scratch.touching_x[solution], scratch.touching_y[solution])};
+            }
+        }
+
+        auto closed_form_points = select_closed_form_curve_points(circles, i, touching_circles[0], touching_circles[1]);
+
+        if (!closed_form_points)
+        {
+            scratch.closed_form_fallbacks++;
+        }
+
+        auto points = closed_form_points ? *closed_form_points : search_curve_points_for_circle<Precision>(circles, i);
+
+        auto separated_points = separate_points<Precision>(std::get<0>(points), std::get<1>(points), circles, i);
+
+        output.left_points[i] = separated_points.left_point;
+        output.right_points[i] = separated_points.right_point;
+    }
+}
+
+template <typename Precision>
+void SkinningContext::calculate_curves(std::span<const SkinCircle> circles, const SkinBuffers &output, int first, int last)
+{
+    ScopedTimer timer(ProfileStage::Tangents);
+
+    int last_circle = (int)circles.size() - 1;
+
+    for (auto i = first; i <= last; i++)
+    {
+        auto tanggents = calculate_tangents<Precision>(
+            circles[i].position, circles[i].radius,
+            circles[i + 1].position, circles[i + 1].radius,
+            output.left_points[i], output.left_points[i + 1]);
+
+        output.curves[i] = HermiteCurve(
+            output.left_points[i], output.left_points[i + 1],
+            std::get<0>(tanggents), std::get<1>(tanggents),
+            LEFT_COLOR);
+    }
+
+    for (auto i = first; i <= last; i++)
+    {
+        auto tanggents = calculate_tangents<Precision>(
+            circles[i].position, circles[i].radius,
+            circles[i + 1].position, circles[i + 1].radius,
+            output.right_points[i], output.right_points[i + 1]);
+
+        output.curves[last_circle + i] = HermiteCurve(
+            output.right_points[i], output.right_points[i + 1],
+            std::get<0>(tanggents), std::get<1>(tanggents),
+            RIGHT_COLOR);
+    }
+}
+
+template <typename Precision>
+void SkinningContext::calculate_window(std::span<const SkinCircle> circles, const SkinBuffers &output, const SkinWindow &window)
+{
+    int last = (int)circles.size() - 1;
+
+    if (window.first_point == 0)
+    {
+        auto first_points = get_tangent_points(
+            circles[0].position, circles[0].radius,
+            circles[1].position, circles[1].radius);
+
+        auto separated_points = separate_end_points(first_points.c1_p1, first_points.c1_p2, circles[0].position, circles[1].position);
+
+        output.left_points[0] = separated_points.left_point;
+        output.right_points[0] = separated_points.right_point;
+    }
+
+    if ((int)window.last_point == last)
+    {
+        auto last_points = get_tangent_points(
+            circles[last - 1].position, circles[last - 1].radius,
+            circles[last].position, circles[last].radius);
+
+        auto separated_points = separate_end_points(last_points.c2_p1, last_points.c2_p2, circles[last - 1].position, circles[last].position);
+
+        output.left_points[last] = separated_points.left_point;
+        output.right_points[last] = separated_points.right_point;
+    }
+
+    int first_interior = glm::max((int)window.first_point, 1);
+    int last_interior = glm::min((int)window.last_point, last - 1);
+
+    auto parallel = thread_pool != nullptr && last_interior - first_interior + 1 > (int)parallel_grain;
+
+    for (auto &scratch : scratches)
+    {
+        scratch.closed_form_fallbacks = 0;
+    }
+
+    if (parallel)
+    {
+        scratches.resize(glm::max(scratches.size(), thread_pool->get_worker_count()));
+
+        // Every chunk writes its own slots of the output, so the result does not depend on the scheduling
+        thread_pool->parallel_for(first_interior, last_interior + 1, parallel_grain, [&](size_t begin, size_t end, size_t worker)
+        {
+            calculate_interior_points<Precision>(circles, output, begin, end - 1, scratches[worker]);
+        });
+
+        thread_pool->parallel_for(window.first_curve, window.last_curve + 1, parallel_grain, [&](size_t begin, size_t end, size_t)
+        {
+            calculate_curves<Precision>(circles, output, begin, end - 1);
+        });
+    }
+    else
+    {
+        if (first_interior <= last_interior)
+        {
+            scratches.resize(glm::max(scratches.size(), (size_t)1));
+
+            calculate_interior_points<Precision>(circles, output, first_interior, last_interior, scratches[0]);
+        }
+
+        calculate_curves<Precision>(circles, output, window.first_curve, window.last_curve);
+    }
+
+    closed_form_fallbacks = 0;
+
+    for (auto &scratch : scratches)
+    {
+        closed_form_fallbacks += scratch.closed_form_fallbacks;
+    }
+}
+
+static bool has_skin_capacity(size_t circle_count, const SkinBuffers &output)
+{
+    auto point_count = skin_point_count(circle_count);
+
+    return point_count != 0
+        && output.left_points.size() >= point_count
+        && output.right_points.size() >= point_count
+        && output.curves.size() >= skin_curve_count(circle_count);
+}
+
+template <typename Precision>
+bool SkinningContext::calculate_skin(std::span<const SkinCircle> circles, const SkinBuffers &output)
+{
+    if (!has_skin_capacity(circles.size(), output))
+    {
+        return false;
+    }
+
+    updated_window = get_skin_window(circles.size(), 0, circles.size() - 1);
+
+    calculate_window<Precision>(circles, output, updated_window);
+
+    skinned_circle_count = circles.size();
+    all_dirty = false;
+    dirty_first = SIZE_MAX;
+    dirty_last = 0;
+
+    return true;
+}
+
+size_t SkinningContext::calculate_skins(std::span<const std::span<const SkinCircle>> chains, std::span<const SkinBuffers> outputs)
+{
+    size_t skinned = 0;
+
+    for (size_t i = 0; i < chains.size() && i < outputs.size(); i++)
+    {
+        if (calculate_skin(chains[i], outputs[i]))
+        {
+            skinned++;
+        }
+    }
+
+    return skinned;
+}
+
+void SkinningContext::mark_dirty(size_t index)
+{
+    mark_dirty(index, index);
+}
+
+void SkinningContext::mark_dirty(size_t first, size_t last)
+{
+    dirty_first = glm::min(dirty_first, first);
+    dirty_last = glm::max(dirty_last, last);
+}
+
+void SkinningContext::mark_all_dirty()
+{
+    all_dirty = true;
+}
+
+bool SkinningContext::update_skin(std::span<const SkinCircle> circles, const SkinBuffers &output)
+{
+    if (all_dirty || circles.size() != skinned_circle_count || dirty_last >= circles.size())
+    {
+        return calculate_skin(circles, output);
+    }
+
+    if (!has_skin_capacity(circles.size(), output))
+    {
+        return false;
+    }
+
+    if (dirty_first > dirty_last)
+    {
+        updated_window = {1, 0, 1, 0};
+        return true;
+    }
+
+    updated_window = get_skin_window(circles.size(), dirty_first, dirty_last);
+
+    calculate_window<FloatPrecision>(circles, output, updated_window);
+
+    dirty_first = SIZE_MAX;
+    dirty_last = 0;
+
+    return true;
+}
+
+const SkinWindow &SkinningContext::get_updated_window() const
+{
+    return updated_window;
+}
+
+size_t SkinningContext::get_closed_form_fallbacks() const
+{
+    return closed_form_fallbacks;
+}
+
+#define INSTANTIATE_GEOMETRY(Precision) \
+    template std::optional<BasicTouchingCircle<Precision::storage_type>> find_touching_circle<Precision>( \
+        const BasicSkinCircle<Precision::storage_type> &, const BasicSkinCircle<Precision::storage_type> &, \
+        const BasicSkinCircle<Precision::storage_type> &, int, int, int); \
+    template BasicRadicalLine<Precision::storage_type> get_radical_line<Precision>( \
+        Precision::storage_vec2, Precision::storage_type, Precision::storage_vec2, Precision::storage_type); \
+    template Precision::storage_vec2 find_radical_center<Precision>( \
+        Precision::storage_vec2, Precision::storage_type, Precision::storage_vec2, Precision::storage_type, \
+        Precision::storage_vec2, Precision::storage_type); \
+    template std::tuple<Precision::storage_vec2, Precision::storage_vec2> calculate_tangents<Precision>( \
+        Precision::storage_vec2, Precision::storage_type, Precision::storage_vec2, Precision::storage_type, \
+        Precision::storage_vec2, Precision::storage_vec2);
+
+// Chains, skin points and curves are float, so the functions taking them only exist for the
+// float-stored policies
+#define INSTANTIATE_SKINNING(Precision) \
+    template std::tuple<glm::vec2, glm::vec2> search_curve_points_for_circle<Precision>(std::span<const SkinCircle>, int); \
+    template std::tuple<glm::vec2, glm::vec2> find_curve_points_for_circle<Precision>(std::span<const SkinCircle>, int); \
+    template SeparatedPoints separate_points<Precision>(glm::vec2, glm::vec2, std::span<const SkinCircle>, int); \
+    template bool SkinningContext::calculate_skin<Precision>(std::span<const SkinCircle>, const SkinBuffers &);
+
+INSTANTIATE_GEOMETRY(FloatPrecision)
+INSTANTIATE_GEOMETRY(MixedPrecision)
+INSTANTIATE_GEOMETRY(DoublePrecision)
+INSTANTIATE_SKINNING(FloatPrecision)
+INSTANTIATE_SKINNING(MixedPrecision)
+
+void SkinStorage::resize(size_t circle_count)
+{
+    left_points.resize(skin_point_count(circle_count));
+    right_points.resize(skin_point_count(circle_count));
+    curves.resize(skin_curve_count(circle_count));
+}
+
+SkinBuffers SkinStorage::get_buffers()
+{
+    return SkinBuffers{left_points, right_points, curves};
+}
@@ -0,0 +1,12 @@
+#version 410
+
+in vec2 texCoord;
+out vec4 FragColor;
+
+uniform sampler2D atlas;
+uniform vec3 color;
+
+void main()
+{
+    FragColor = vec4(color, texture(atlas, texCoord).r);
+}
@@ -0,0 +1,254 @@
+#include <filesystem>
+#include <fmt/core.h>
+#include <ft2build.h>
+#include FT_FREETYPE_H
+#include <glm/gtc/type_ptr.hpp>
+#include <renderer.hpp>
+#include <text_overlay.hpp>
+
+std::string find_overlay_font()
+{
+    const char *candidates[] = {
+        "/usr/share/fonts/truetype/dejavu/DejaVuSansMono.ttf",
+        "/usr/share/fonts/TTF/DejaVuSansMono.ttf",
+        "/usr/share/fonts/dejavu-sans-mono-fonts/DejaVuSansMono.ttf",
+        "/System/Library/Fonts/Menlo.ttc",
+        "C:/Windows/Fonts/consola.ttf",
+    };
+
+    for (auto candidate : candidates)
+    {
+        if (std::filesystem::exists(candidate))
+        {
+            return candidate;
+        }
+    }
+
+    return "";
+}
+
+bool TextOverlay::load_atlas(const std::string &font_path, int pixel_size)
+{
+    FT_Library library;
+
+    if (FT_Init_FreeType(&library))
+    {
+        fmt::println("Failed to initialize Freetype");
+        return false;
+    }
+
+    FT_Face face;
+
+    if (FT_New_Face(library, font_path.c_str(), 0, &face))
+    {
+        fmt::println("Failed to load font {}", font_path);
+        FT_Done_FreeType(library);
+        return false;
+    }
+
+    FT_Set_Pixel_Sizes(face, 0, pixel_size);
+    line_height = face->size->metrics.height / 64.0f;
+
+    // Glyphs are packed in rows left to right, with a pixel of padding against bleeding
+    std::vector<unsigned char> atlas;
+    int pen_x = 0;
+    int pen_y = 0;
+    int row_height = 0;
+    std::vector<glm::ivec2> offsets(TEXT_GLYPH_COUNT);
+
+    for (auto pass = 0; pass < 2; pass++)
+    {
+        pen_x = 0;
+        pen_y = 0;
+        row_height = 0;
+
+        for (auto i = 0; i < TEXT_GLYPH_COUNT; i++)
+        {
+            if (pass == 0)
+            {
+                glyphs[i] = Glyph{};
+            }
+
+            if (FT_Load_Char(face, TEXT_FIRST_GLYPH + i, FT_LOAD_RENDER))
+            {
+                continue;
+            }
+
+            auto &bitmap = face->glyph->bitmap;
+
+            if (pen_x + (int)bitmap.width + 1 > TEXT_ATLAS_WIDTH)
+            {
+                pen_x = 0;
+                pen_y += row_height + 1;
+                row_height = 0;
+            }
+
+            if (pass == 0)
+            {
+                offsets[i] = glm::ivec2(pen_x, pen_y);
+                glyphs[i].size = glm::vec2(bitmap.width, bitmap.rows);
+                glyphs[i].bearing = glm::vec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+                glyphs[i].advance = face->glyph->advance.x / 64.0f;
+            }
+            else
+            {
+                for (unsigned int row = 0; row < bitmap.rows; row++)
+                {
+                    auto source = bitmap.buffer + row * bitmap.pitch;
+
+                    std::copy(source, source + bitmap.width, atlas.begin() + (offsets[i].y + row) * TEXT_ATLAS_WIDTH + offsets[i].x);
+                }
+            }
+
+            pen_x += bitmap.width + 1;
+            row_height = glm::max(row_height, (int)bitmap.rows);
+        }
+
+        // The first pass only measures, the atlas height is known after it
+        if (pass == 0)
+        {
+            atlas.resize(TEXT_ATLAS_WIDTH * (pen_y + row_height + 1));
+        }
+    }
+
+    auto atlas_height = (int)(atlas.size() / TEXT_ATLAS_WIDTH);
+
+    for (auto i = 0; i < TEXT_GLYPH_COUNT; i++)
+    {
+        glyphs[i].atlas_min = glm::vec2(offsets[i]) / glm::vec2(TEXT_ATLAS_WIDTH, atlas_height);
+        glyphs[i].atlas_max = (glm::vec2(offsets[i]) + glyphs[i].size) / glm::vec2(TEXT_ATLAS_WIDTH, atlas_height);
+    }
+
+    FT_Done_Face(face);
+    FT_Done_FreeType(library);
+
+    glGenTextures(1, &atlas_texture);
+    glBindTexture(GL_TEXTURE_2D, atlas_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, TEXT_ATLAS_WIDTH, atlas_height, 0, GL_RED, GL_UNSIGNED_BYTE, atlas.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return true;
+}
+
+bool TextOverlay::initialize(const std::string &font_path, int pixel_size)
+{
+    if (!load_atlas(font_path, pixel_size))
+    {
+        return false;
+    }
+
+    program = get_shader_program("text_vertex.glsl", "text_fragment.glsl");
+
+    if (program == 0)
+    {
+        destroy();
+        return false;
+    }
+
+    projection_uniform = glGetUniformLocation(program, "projection");
+    color_uniform = glGetUniformLocation(program, "color");
+
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "atlas"), 0);
+
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+
+    return true;
+}
+
+void TextOverlay::destroy()
+{
+    glDeleteProgram(program);
+    glDeleteTextures(1, &atlas_texture);
+    glDeleteVertexArrays(1, &vao);
+    glDeleteBuffers(1, &vbo);
+
+    program = 0;
+    atlas_texture = 0;
+    vao = 0;
+    vbo = 0;
+}
+
+bool TextOverlay::is_initialized() const
+{
+    return program != 0;
+}
+
+void TextOverlay::draw(const glm::mat4 &projection, std::string_view text, glm::vec2 position, glm::vec3 color)
+{
+    if (!is_initialized())
+    {
+        return;
+    }
+
+    vertex_data.clear();
+
+    auto pen = glm::vec2(position.x, position.y + line_height);
+
+    for (auto character : text)
+    {
+        if (character == '\n')
+        {
+            pen = glm::vec2(position.x, pen.y + line_height);
+            continue;
+        }
+
+        auto index = (int)(unsigned char)character - TEXT_FIRST_GLYPH;
+
+        if (index < 0 || index >= TEXT_GLYPH_COUNT)
+        {
+            continue;
+        }
+
+        auto &glyph = glyphs[index];
+
+        // Screen space grows downwards, the bearing points up from the baseline
+        auto min = glm::vec2(pen.x + glyph.bearing.x, pen.y - glyph.bearing.y);
+        auto max = min + glyph.size;
+
+        float quad[] = {
+            min.x, min.y, glyph.atlas_min.x, glyph.atlas_min.y,
+            max.x, min.y, glyph.atlas_max.x, glyph.atlas_min.y,
+            max.x, max.y, glyph.atlas_max.x, glyph.atlas_max.y,
+            min.x, min.y, glyph.atlas_min.x, glyph.atlas_min.y,
+            max.x, max.y, glyph.atlas_max.x, glyph.atlas_max.y,
+            min.x, max.y, glyph.atlas_min.x, glyph.atlas_max.y,
+        };
+
+        vertex_data.insert(vertex_data.end(), std::begin(quad), std::end(quad));
+        pen.x += glyph.advance;
+    }
+
+    glUseProgram(program);
+    glUniformMatrix4fv(projection_uniform, 1, GL_FALSE, glm::value_ptr(projection));
+    glUniform3f(color_uniform, color.x, color.y, color.z);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, atlas_texture);
+
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertex_data.size() * sizeof(float), vertex_data.data(), GL_STREAM_DRAW);
+
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glDrawArrays(GL_TRIANGLES, 0, vertex_data.size() / 4);
+    glDisable(GL_BLEND);
+
+    glBindVertexArray(0);
+}
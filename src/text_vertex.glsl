@@ -0,0 +1,14 @@
+#version 410
+
+layout (location = 0) in vec2 aPos;
+layout (location = 1) in vec2 aTexCoord;
+
+out vec2 texCoord;
+
+uniform mat4 projection;
+
+void main()
+{
+    gl_Position = projection * vec4(aPos, 1.0, 1.0);
+    texCoord = aTexCoord;
+}
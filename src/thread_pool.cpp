@@ -0,0 +1,157 @@
+#include <thread_pool.hpp>
+
+ThreadPool::ThreadPool(size_t thread_count)
+{
+    for (size_t i = 0; i < thread_count + 1; i++)
+    {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    for (size_t i = 0; i < thread_count; i++)
+    {
+        threads.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(wake_mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::get_worker_count() const
+{
+    return queues.size();
+}
+
+bool ThreadPool::pop_chunk(size_t worker, Chunk &chunk)
+{
+    // Own queue from the back, the chunks pushed last are the most likely to still be in cache
+    {
+        auto &queue = *queues[worker];
+        std::lock_guard lock(queue.mutex);
+
+        if (queue.head < queue.chunks.size())
+        {
+            chunk = queue.chunks.back();
+            queue.chunks.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < queues.size(); i++)
+    {
+        auto &queue = *queues[(worker + i) % queues.size()];
+        std::lock_guard lock(queue.mutex);
+
+        if (queue.head < queue.chunks.size())
+        {
+            chunk = queue.chunks[queue.head++];
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ThreadPool::run_chunk(size_t worker)
+{
+    Chunk chunk;
+
+    if (!pop_chunk(worker, chunk))
+    {
+        return false;
+    }
+
+    job_function(job_context, chunk.begin, chunk.end, worker);
+
+    remaining_chunks.fetch_sub(1, std::memory_order_acq_rel);
+
+    return true;
+}
+
+void ThreadPool::worker_loop(size_t worker)
+{
+    uint64_t seen_generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock lock(wake_mutex);
+            wake.wait(lock, [&] { return stopping || job_generation != seen_generation; });
+
+            if (stopping)
+            {
+                return;
+            }
+
+            seen_generation = job_generation;
+        }
+
+        while (run_chunk(worker))
+        {
+        }
+    }
+}
+
+void ThreadPool::run(size_t begin, size_t end, size_t grain, JobFunction function, void *context)
+{
+    if (begin >= end)
+    {
+        return;
+    }
+
+    grain = grain == 0 ? 1 : grain;
+
+    std::lock_guard job_lock(job_mutex);
+
+    job_function = function;
+    job_context = context;
+
+    size_t chunk_count = (end - begin + grain - 1) / grain;
+    remaining_chunks.store(chunk_count, std::memory_order_release);
+
+    for (size_t i = 0; i < chunk_count; i++)
+    {
+        auto &queue = *queues[i % queues.size()];
+        std::lock_guard lock(queue.mutex);
+
+        if (queue.head == queue.chunks.size())
+        {
+            queue.chunks.clear();
+            queue.head = 0;
+        }
+
+        auto chunk_begin = begin + i * grain;
+        queue.chunks.push_back(Chunk{chunk_begin, chunk_begin + grain < end ? chunk_begin + grain : end});
+    }
+
+    if (!threads.empty())
+    {
+        {
+            std::lock_guard lock(wake_mutex);
+            job_generation++;
+        }
+
+        wake.notify_all();
+    }
+
+    auto caller = queues.size() - 1;
+
+    while (remaining_chunks.load(std::memory_order_acquire) != 0)
+    {
+        if (!run_chunk(caller))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
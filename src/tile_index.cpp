@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cmath>
+#include <tile_index.hpp>
+
+static bool is_finite(glm::vec2 point)
+{
+    return std::isfinite(point.x) && std::isfinite(point.y);
+}
+
+void TileIndex::build(std::span<const glm::vec2> low, std::span<const glm::vec2> high)
+{
+    auto scene_low = glm::vec2(0.0f);
+    auto scene_high = glm::vec2(0.0f);
+    auto any_finite = false;
+
+    for (size_t i = 0; i < low.size(); i++)
+    {
+        if (!is_finite(low[i]) || !is_finite(high[i]))
+        {
+            continue;
+        }
+
+        scene_low = any_finite ? glm::min(scene_low, low[i]) : low[i];
+        scene_high = any_finite ? glm::max(scene_high, high[i]) : high[i];
+        any_finite = true;
+    }
+
+    auto extent = scene_high - scene_low;
+
+    origin = scene_low;
+    tile_size = glm::max(RENDER_TILE_SIZE, glm::max(extent.x, extent.y) / MAX_RENDER_TILES_PER_AXIS);
+    columns = any_finite ? glm::min((int)(extent.x / tile_size) + 1, MAX_RENDER_TILES_PER_AXIS) : 0;
+    rows = any_finite ? glm::min((int)(extent.y / tile_size) + 1, MAX_RENDER_TILES_PER_AXIS) : 0;
+
+    object_tiles.resize(low.size());
+    tile_starts.assign((size_t)columns * rows + 1, 0);
+
+    // Counting sort into the tiles, objects of a tile end up in increasing order
+    for (size_t i = 0; i < low.size(); i++)
+    {
+        auto &range = object_tiles[i];
+
+        if (!is_finite(low[i]) || !is_finite(high[i]))
+        {
+            range = TileRange{0, 0, -1, -1};
+            continue;
+        }
+
+        range = get_tile_range(low[i], high[i]);
+
+        for (auto y = range.min_y; y <= range.max_y; y++)
+        {
+            for (auto x = range.min_x; x <= range.max_x; x++)
+            {
+                tile_starts[y * columns + x + 1]++;
+            }
+        }
+    }
+
+    for (size_t tile = 1; tile < tile_starts.size(); tile++)
+    {
+        tile_starts[tile] += tile_starts[tile - 1];
+    }
+
+    tile_objects.resize(tile_starts.back());
+
+    auto next = std::vector<uint32_t>(tile_starts.begin(), tile_starts.end() - 1);
+
+    for (size_t i = 0; i < object_tiles.size(); i++)
+    {
+        auto &range = object_tiles[i];
+
+        for (auto y = range.min_y; y <= range.max_y; y++)
+        {
+            for (auto x = range.min_x; x <= range.max_x; x++)
+            {
+                tile_objects[next[y * columns + x]++] = i;
+            }
+        }
+    }
+}
+
+size_t TileIndex::size() const
+{
+    return object_tiles.size();
+}
+
+TileRange TileIndex::get_tile_range(glm::vec2 low, glm::vec2 high) const
+{
+    // Clamped before the conversion, points far outside the grid would not fit an int. A
+    // rectangle missing the grid ends up with min > max on some axis.
+    auto limit = glm::vec2((float)columns, (float)rows);
+    auto min = glm::clamp(glm::floor((low - origin) / tile_size), glm::vec2(0.0f), limit);
+    auto max = glm::clamp(glm::floor((high - origin) / tile_size), glm::vec2(-1.0f), limit - glm::vec2(1.0f));
+
+    return TileRange{(int)min.x, (int)min.y, (int)max.x, (int)max.y};
+}
+
+void TileIndex::query(const TileRange &range, std::vector<uint32_t> &objects) const
+{
+    objects.clear();
+
+    if (range.min_x > range.max_x || range.min_y > range.max_y)
+    {
+        return;
+    }
+
+    // The whole grid, which is every object with finite bounds in order
+    if (range == TileRange{0, 0, columns - 1, rows - 1})
+    {
+        for (size_t i = 0; i < object_tiles.size(); i++)
+        {
+            if (object_tiles[i].min_x <= object_tiles[i].max_x)
+            {
+                objects.push_back(i);
+            }
+        }
+
+        return;
+    }
+
+    for (auto y = range.min_y; y <= range.max_y; y++)
+    {
+        for (auto x = range.min_x; x <= range.max_x; x++)
+        {
+            auto tile = y * columns + x;
+
+            for (auto i = tile_starts[tile]; i < tile_starts[tile + 1]; i++)
+            {
+                auto object = tile_objects[i];
+                auto &object_range = object_tiles[object];
+
+                // An object spanning several tiles is taken from the first of them inside the range
+                if (x == std::max(object_range.min_x, range.min_x) && y == std::max(object_range.min_y, range.min_y))
+                {
+                    objects.push_back(object);
+                }
+            }
+        }
+    }
+
+    std::sort(objects.begin(), objects.end());
+}
@@ -0,0 +1,163 @@
+#include <cmath>
+#include <touching_circle_kernel.hpp>
+#include <touching_circle_lanes.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TOUCHING_CIRCLE_HAS_SSE2
+#endif
+
+#if defined(TOUCHING_CIRCLE_HAS_AVX2) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#ifdef TOUCHING_CIRCLE_HAS_AVX2
+size_t solve_touching_circles_avx2(const float *x, const float *y, const float *radius, size_t count, size_t out_stride, float *out_x, float *out_y, float *out_radius, uint8_t *out_valid);
+#endif
+
+namespace
+{
+    struct ScalarLanes
+    {
+        using type = float;
+        static constexpr size_t width = 1;
+        static float load(const float *p) { return *p; }
+        static void store(float *p, float v) { *p = v; }
+        static void store_valid(uint8_t *p, float v) { *p = !(v < 0); }
+        static float set1(float v) { return v; }
+        static float add(float a, float b) { return a + b; }
+        static float sub(float a, float b) { return a - b; }
+        static float mul(float a, float b) { return a * b; }
+        static float div(float a, float b) { return a / b; }
+        static float neg(float a) { return -a; }
+        static float sqrt(float a) { return std::sqrt(a); }
+    };
+
+#ifdef TOUCHING_CIRCLE_HAS_SSE2
+    struct Sse2Lanes
+    {
+        using type = __m128;
+        static constexpr size_t width = 4;
+        static __m128 load(const float *p) { return _mm_loadu_ps(p); }
+        static void store(float *p, __m128 v) { _mm_storeu_ps(p, v); }
+        static void store_valid(uint8_t *p, __m128 v)
+        {
+            int mask = _mm_movemask_ps(_mm_cmpnlt_ps(v, _mm_setzero_ps()));
+
+            for (int j = 0; j < 4; j++)
+            {
+                p[j] = (mask >> j) & 1;
+            }
+        }
+        static __m128 set1(float v) { return _mm_set1_ps(v); }
+        static __m128 add(__m128 a, __m128 b) { return _mm_add_ps(a, b); }
+        static __m128 sub(__m128 a, __m128 b) { return _mm_sub_ps(a, b); }
+        static __m128 mul(__m128 a, __m128 b) { return _mm_mul_ps(a, b); }
+        static __m128 div(__m128 a, __m128 b) { return _mm_div_ps(a, b); }
+        static __m128 neg(__m128 a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+        static __m128 sqrt(__m128 a) { return _mm_sqrt_ps(a); }
+    };
+#endif
+
+    template <typename Lanes>
+    size_t solve_touching_circles(const float *x, const float *y, const float *radius, size_t count, size_t out_stride, float *out_x, float *out_y, float *out_radius, uint8_t *out_valid)
+    {
+        return solve_touching_circle_lanes<Lanes>(x, y, radius, count, out_stride, out_x, out_y, out_radius, out_valid);
+    }
+}
+
+void find_touching_circles(KernelIsa isa, std::span<const float> x, std::span<const float> y, std::span<const float> radius, size_t first, size_t count, const TouchingCircleArrays &output)
+{
+    const float *x_data = x.data() + first - 1;
+    const float *y_data = y.data() + first - 1;
+    const float *radius_data = radius.data() + first - 1;
+
+    size_t done = 0;
+
+#ifdef TOUCHING_CIRCLE_HAS_AVX2
+    if (isa == KernelIsa::Avx2)
+    {
+        done += solve_touching_circles_avx2(
+            x_data, y_data, radius_data, count, count,
+            output.x.data(), output.y.data(), output.radius.data(), output.valid.data());
+    }
+#endif
+
+#ifdef TOUCHING_CIRCLE_HAS_SSE2
+    if (isa != KernelIsa::Scalar)
+    {
+        done += solve_touching_circles<Sse2Lanes>(
+            x_data + done, y_data + done, radius_data + done, count - done, count,
+            output.x.data() + done, output.y.data() + done, output.radius.data() + done, output.valid.data() + done);
+    }
+#endif
+
+    solve_touching_circles<ScalarLanes>(
+        x_data + done, y_data + done, radius_data + done, count - done, count,
+        output.x.data() + done, output.y.data() + done, output.radius.data() + done, output.valid.data() + done);
+}
+
+void find_touching_circles(std::span<const float> x, std::span<const float> y, std::span<const float> radius, size_t first, size_t count, const TouchingCircleArrays &output)
+{
+    static const KernelIsa best_isa = get_best_kernel_isa();
+
+    find_touching_circles(best_isa, x, y, radius, first, count, output);
+}
+
+#ifdef TOUCHING_CIRCLE_HAS_AVX2
+static bool cpu_supports_avx2()
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+
+    if (info[0] < 7)
+    {
+        return false;
+    }
+
+    // AVX needs OSXSAVE and the OS saving the YMM registers, AVX2 is bit 5 of leaf 7
+    __cpuid(info, 1);
+
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 6) != 6)
+    {
+        return false;
+    }
+
+    __cpuidex(info, 7, 0);
+
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+KernelIsa get_best_kernel_isa()
+{
+#ifdef TOUCHING_CIRCLE_HAS_AVX2
+    if (cpu_supports_avx2())
+    {
+        return KernelIsa::Avx2;
+    }
+#endif
+
+#ifdef TOUCHING_CIRCLE_HAS_SSE2
+    return KernelIsa::Sse2;
+#else
+    return KernelIsa::Scalar;
+#endif
+}
+
+const char * get_kernel_isa_name(KernelIsa isa)
+{
+    switch (isa)
+    {
+    case KernelIsa::Avx2:
+        return "avx2";
+    case KernelIsa::Sse2:
+        return "sse2";
+    default:
+        return "scalar";
+    }
+}
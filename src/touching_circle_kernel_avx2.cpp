@@ -0,0 +1,37 @@
+// Compiled with AVX2 enabled. Keep the includes to the intrinsics and the lane template, any
+// shared inline function instantiated here could end up as the AVX2 copy in the whole program.
+
+#include <immintrin.h>
+#include <touching_circle_lanes.hpp>
+
+namespace
+{
+    struct Avx2Lanes
+    {
+        using type = __m256;
+        static constexpr size_t width = 8;
+        static __m256 load(const float *p) { return _mm256_loadu_ps(p); }
+        static void store(float *p, __m256 v) { _mm256_storeu_ps(p, v); }
+        static void store_valid(uint8_t *p, __m256 v)
+        {
+            int mask = _mm256_movemask_ps(_mm256_cmp_ps(v, _mm256_setzero_ps(), _CMP_NLT_UQ));
+
+            for (int j = 0; j < 8; j++)
+            {
+                p[j] = (mask >> j) & 1;
+            }
+        }
+        static __m256 set1(float v) { return _mm256_set1_ps(v); }
+        static __m256 add(__m256 a, __m256 b) { return _mm256_add_ps(a, b); }
+        static __m256 sub(__m256 a, __m256 b) { return _mm256_sub_ps(a, b); }
+        static __m256 mul(__m256 a, __m256 b) { return _mm256_mul_ps(a, b); }
+        static __m256 div(__m256 a, __m256 b) { return _mm256_div_ps(a, b); }
+        static __m256 neg(__m256 a) { return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f)); }
+        static __m256 sqrt(__m256 a) { return _mm256_sqrt_ps(a); }
+    };
+}
+
+size_t solve_touching_circles_avx2(const float *x, const float *y, const float *radius, size_t count, size_t out_stride, float *out_x, float *out_y, float *out_radius, uint8_t *out_valid)
+{
+    return solve_touching_circle_lanes<Avx2Lanes>(x, y, radius, count, out_stride, out_x, out_y, out_radius, out_valid);
+}
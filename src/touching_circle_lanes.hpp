@@ -0,0 +1,80 @@
+#pragma once
+
+// Shared body of the touching circle kernel. Included by every ISA-specific translation unit,
+// so it must not pull in anything with inline functions besides the intrinsics themselves.
+
+#include <cstddef>
+#include <cstdint>
+
+// Same formula and operation order as find_touching_circle with the signs (1, 1, 1), evaluated on
+// Lanes::width triples at once. The centres of triple i are x[i], x[i + 1] and x[i + 2]. The
+// solution for (-1, -1, -1) is stored out_stride entries after it: with every sign negated a1,
+// b1 and C1 change sign and nothing else, so it is the other root with the terms negated.
+template <typename Lanes>
+size_t solve_touching_circle_lanes(const float *x, const float *y, const float *radius, size_t count, size_t out_stride, float *out_x, float *out_y, float *out_radius, uint8_t *out_valid)
+{
+    using V = typename Lanes::type;
+
+    auto two = Lanes::set1(2.0f);
+    auto one = Lanes::set1(1.0f);
+
+    size_t i = 0;
+
+    for (; i + Lanes::width <= count; i += Lanes::width)
+    {
+        V x1 = Lanes::load(x + i);
+        V y1 = Lanes::load(y + i);
+        V x2 = Lanes::load(x + i + 1);
+        V y2 = Lanes::load(y + i + 1);
+        V x3 = Lanes::load(x + i + 2);
+        V y3 = Lanes::load(y + i + 2);
+
+        V r1 = Lanes::load(radius + i);
+        V r2 = Lanes::load(radius + i + 1);
+        V r3 = Lanes::load(radius + i + 2);
+
+        V r1_2 = Lanes::mul(r1, r1);
+        V x1_2 = Lanes::mul(x1, x1);
+        V y1_2 = Lanes::mul(y1, y1);
+
+        V k_a = Lanes::sub(Lanes::add(Lanes::sub(Lanes::add(Lanes::add(Lanes::neg(r1_2), Lanes::mul(r2, r2)), x1_2), Lanes::mul(x2, x2)), y1_2), Lanes::mul(y2, y2));
+        V k_b = Lanes::sub(Lanes::add(Lanes::sub(Lanes::add(Lanes::add(Lanes::neg(r1_2), Lanes::mul(r3, r3)), x1_2), Lanes::mul(x3, x3)), y1_2), Lanes::mul(y3, y3));
+
+        V y2_y3 = Lanes::sub(y2, y3);
+        V y3_y1 = Lanes::sub(y3, y1);
+        V y1_y2 = Lanes::sub(y1, y2);
+
+        V d = Lanes::add(Lanes::add(Lanes::mul(x1, y2_y3), Lanes::mul(x2, y3_y1)), Lanes::mul(x3, y1_y2));
+        V d2 = Lanes::mul(two, d);
+
+        V a0 = Lanes::div(Lanes::add(Lanes::mul(k_a, Lanes::sub(y1, y3)), Lanes::mul(k_b, Lanes::sub(y2, y1))), d2);
+        V b0 = Lanes::div(Lanes::neg(Lanes::add(Lanes::mul(k_a, Lanes::sub(x1, x3)), Lanes::mul(k_b, Lanes::sub(x2, x1)))), d2);
+
+        V a1 = Lanes::div(Lanes::neg(Lanes::add(Lanes::add(Lanes::mul(r1, y2_y3), Lanes::mul(r2, y3_y1)), Lanes::mul(r3, y1_y2))), d);
+        V b1 = Lanes::div(Lanes::add(Lanes::add(Lanes::mul(r1, Lanes::sub(x2, x3)), Lanes::mul(r2, Lanes::sub(x3, x1))), Lanes::mul(r3, Lanes::sub(x1, x2))), d);
+
+        V C0 = Lanes::add(Lanes::add(Lanes::sub(Lanes::sub(Lanes::add(Lanes::sub(Lanes::mul(a0, a0), Lanes::mul(Lanes::mul(two, a0), x1)), Lanes::mul(b0, b0)), Lanes::mul(Lanes::mul(two, b0), y1)), r1_2), x1_2), y1_2);
+        V C1 = Lanes::sub(Lanes::sub(Lanes::add(Lanes::sub(Lanes::mul(a0, a1), Lanes::mul(a1, x1)), Lanes::mul(b0, b1)), Lanes::mul(b1, y1)), r1);
+        V C2 = Lanes::sub(Lanes::add(Lanes::mul(a1, a1), Lanes::mul(b1, b1)), one);
+
+        V root_inner = Lanes::sub(Lanes::mul(C1, C1), Lanes::mul(C0, C2));
+
+        V root = Lanes::neg(Lanes::sqrt(root_inner));
+
+        V outer_r = Lanes::div(Lanes::sub(root, C1), C2);
+
+        Lanes::store(out_radius + i, outer_r);
+        Lanes::store(out_x + i, Lanes::add(a0, Lanes::mul(a1, outer_r)));
+        Lanes::store(out_y + i, Lanes::add(b0, Lanes::mul(b1, outer_r)));
+        Lanes::store_valid(out_valid + i, root_inner);
+
+        V inner_r = Lanes::div(Lanes::add(root, C1), C2);
+
+        Lanes::store(out_radius + out_stride + i, inner_r);
+        Lanes::store(out_x + out_stride + i, Lanes::sub(a0, Lanes::mul(a1, inner_r)));
+        Lanes::store(out_y + out_stride + i, Lanes::sub(b0, Lanes::mul(b1, inner_r)));
+        Lanes::store_valid(out_valid + out_stride + i, root_inner);
+    }
+
+    return i;
+}
@@ -1,15 +1,16 @@
 #version 410
 
 layout (location = 0) in vec2 aPos;
-layout (location = 1) in vec3 aColor;
 
 out vec3 vertexColor;
 
-uniform mat4 model;
 uniform mat4 projection;
+uniform vec2 origin;
+uniform float fixed_point_step;
+uniform vec3 color;
 
 void main()
 {
-    gl_Position = projection * model * vec4(aPos.x, aPos.y, 1.0, 1.0);
-    vertexColor = aColor;
+    gl_Position = projection * vec4(origin + aPos * fixed_point_step, 1.0, 1.0);
+    vertexColor = color;
 }
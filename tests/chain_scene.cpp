@@ -0,0 +1,156 @@
+#include <chain_generator.hpp>
+#include <chain_scene.hpp>
+#include <circle.hpp>
+#include <fmt/core.h>
+#include <random>
+#include <test_chains.hpp>
+#include <thread_pool.hpp>
+
+#define TEST_SEEDS 8
+#define TEST_EDITS 300
+#define TEST_MAX_CHAIN_CIRCLES 24
+
+// Skin of every chain calculated on its own and laid out as ChainScene describes
+static SkinStorage skin_chains_separately(const ChainScene &scene)
+{
+    SkinStorage expected;
+
+    for (size_t chain = 0; chain < scene.get_chain_count(); chain++)
+    {
+        auto circles = scene.get_chain_circles(chain);
+
+        if (circles.size() < 2)
+        {
+            for (auto &circle : circles)
+            {
+                expected.left_points.push_back(circle.position);
+                expected.right_points.push_back(circle.position);
+            }
+
+            continue;
+        }
+
+        SkinStorage skin;
+        SkinningContext context;
+
+        skin.resize(circles.size());
+        context.calculate_skin(circles, skin.get_buffers());
+
+        expected.left_points.insert(expected.left_points.end(), skin.left_points.begin(), skin.left_points.end());
+        expected.right_points.insert(expected.right_points.end(), skin.right_points.begin(), skin.right_points.end());
+        expected.curves.insert(expected.curves.end(), skin.curves.begin(), skin.curves.end());
+    }
+
+    return expected;
+}
+
+// A circle next to the last one of the chain, or anywhere when it is empty
+static SkinCircle generate_circle(const ChainScene &scene, size_t chain, std::mt19937 &random)
+{
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    auto circles = scene.get_chain_circles(chain);
+    auto radius = MIN_CIRCLE_SIZE + unit(random) * (MAX_CIRCLE_SIZE - MIN_CIRCLE_SIZE) * 0.5f;
+    auto position = glm::vec2(unit(random), unit(random)) * 1000.0f;
+
+    if (!circles.empty())
+    {
+        auto direction = unit(random) * 6.28f;
+
+        position = circles.back().position + (circles.back().radius + radius) * glm::vec2(glm::cos(direction), glm::sin(direction));
+    }
+
+    return SkinCircle{position, radius};
+}
+
+// Applies one random edit and returns its name
+static const char *apply_edit(ChainScene &scene, std::mt19937 &random)
+{
+    auto kind = random() % 8;
+
+    if (kind == 0)
+    {
+        scene.add_chain();
+        return "add_chain";
+    }
+
+    auto chain = random() % scene.get_chain_count();
+
+    if (kind <= 3 && scene.get_chain_circles(chain).size() < TEST_MAX_CHAIN_CIRCLES)
+    {
+        scene.append_circle(chain, generate_circle(scene, chain, random));
+        return "append_circle";
+    }
+
+    if (scene.get_circle_count() == 0)
+    {
+        return "none";
+    }
+
+    auto index = random() % scene.get_circle_count();
+
+    if (kind <= 5)
+    {
+        scene.erase_circle(index);
+        return "erase_circle";
+    }
+
+    auto circle = scene.get_circles()[index];
+    std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+
+    circle.position += glm::vec2(offset(random), offset(random));
+    scene.set_circle(index, circle);
+    return "set_circle";
+}
+
+// Inserting or erasing a circle shifts the points and curves of every later chain, their skins
+// must still be what skinning each chain on its own gives
+int main()
+{
+    ThreadPool thread_pool;
+    size_t failures = 0;
+
+    for (unsigned int seed = 1; seed <= TEST_SEEDS && failures == 0; seed++)
+    {
+        std::mt19937 random(seed);
+        ChainScene scene;
+
+        // Odd seeds skin the dirty chains on the pool
+        scene.thread_pool = seed % 2 == 1 ? &thread_pool : nullptr;
+
+        // Chains of no, one and two circles are skinned differently from the rest
+        for (size_t count : { 0, 1, 2, 3, 12 })
+        {
+            auto chain = scene.add_chain();
+
+            for (auto &circle : generate_chain(ChainKind::Random, count, seed + chain))
+            {
+                scene.append_circle(chain, circle);
+            }
+        }
+
+        scene.update_skins();
+
+        for (auto edit = 0; edit < TEST_EDITS; edit++)
+        {
+            const char *name = nullptr;
+
+            // Several edits, often in different chains, before one update
+            for (auto edits = 1 + random() % 3; edits > 0; edits--)
+            {
+                name = apply_edit(scene, random);
+            }
+
+            scene.update_skins();
+
+            if (auto differences = count_skin_differences(skin_chains_separately(scene), scene.get_skin()))
+            {
+                fmt::println("seed {}: {} points or curves differ after edit {} ({})", seed, differences, edit, name);
+                failures++;
+                break;
+            }
+        }
+    }
+
+    return failures > 0 ? 1 : 0;
+}
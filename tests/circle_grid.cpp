@@ -0,0 +1,167 @@
+#include <circle.hpp>
+#include <circle_grid.hpp>
+#include <cmath>
+#include <fmt/core.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+#define TEST_SEEDS 16
+#define TEST_EDITS 2000
+#define TEST_QUERIES_PER_EDIT 16
+// Circles and queries mostly fall into this square around the origin
+#define TEST_AREA 2000.0f
+
+struct TestCircle
+{
+    glm::vec2 position;
+    float radius;
+};
+
+// Uniform in the unit square around the origin
+static glm::vec2 generate_offset(std::mt19937 &random)
+{
+    std::uniform_real_distribution<float> unit(-0.5f, 0.5f);
+
+    return glm::vec2(unit(random), unit(random));
+}
+
+// Mostly regular circles, now and then huge, empty or broken ones
+static TestCircle generate_circle(std::mt19937 &random)
+{
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    auto position = generate_offset(random) * TEST_AREA;
+    auto radius = MIN_CIRCLE_SIZE + unit(random) * (MAX_CIRCLE_SIZE - MIN_CIRCLE_SIZE);
+
+    switch (random() % 24)
+    {
+        case 0: radius = 1e4f; break;
+        case 1: radius = 1e30f; break;
+        case 2: radius = std::numeric_limits<float>::max(); break;
+        case 3: radius = 0.0f; break;
+        case 4: radius = -radius; break;
+        case 5: radius = std::numeric_limits<float>::quiet_NaN(); break;
+        case 6: radius = std::numeric_limits<float>::infinity(); break;
+        case 7: position.x = std::numeric_limits<float>::quiet_NaN(); break;
+        case 8: position.y = -std::numeric_limits<float>::infinity(); break;
+        case 9: position *= 1e20f; break;
+    }
+
+    return TestCircle{position, radius};
+}
+
+// Near a circle of the list, anywhere in the area, far outside of it or not a point at all
+static glm::vec2 generate_point(const std::vector<TestCircle> &circles, std::mt19937 &random)
+{
+    auto offset = generate_offset(random) * 2.0f * MAX_CIRCLE_SIZE;
+
+    switch (random() % 8)
+    {
+        case 0: return generate_offset(random) * TEST_AREA;
+        case 1: return generate_offset(random) * 1e25f;
+        case 2: return glm::vec2(std::numeric_limits<float>::quiet_NaN(), 0.0f);
+    }
+
+    if (circles.empty())
+    {
+        return offset;
+    }
+
+    return circles[random() % circles.size()].position + offset;
+}
+
+// What the editor did before the grid: walk the list and keep the lowest index containing the
+// point. Circles the grid can never pick are skipped.
+static int find_first_linear(const std::vector<TestCircle> &circles, glm::vec2 point)
+{
+    int first = -1;
+
+    for (auto i = (int)circles.size() - 1; i >= 0; i--)
+    {
+        auto &circle = circles[i];
+        auto finite = std::isfinite(circle.position.x) && std::isfinite(circle.position.y) && std::isfinite(circle.radius);
+
+        if (finite && glm::distance(point, circle.position) <= circle.radius)
+        {
+            first = i;
+        }
+    }
+
+    return first;
+}
+
+// The grid mirrors every edit of the circle list and must pick what a linear scan picks
+int main()
+{
+    size_t failures = 0;
+
+    for (unsigned int seed = 1; seed <= TEST_SEEDS && failures == 0; seed++)
+    {
+        std::mt19937 random(seed);
+        std::vector<TestCircle> circles;
+        CircleGrid grid;
+
+        for (auto edit = 0; edit < TEST_EDITS && failures == 0; edit++)
+        {
+            auto kind = circles.empty() ? 0 : random() % 4;
+            auto index = circles.empty() ? 0 : random() % circles.size();
+            auto circle = generate_circle(random);
+            const char *name;
+
+            switch (kind)
+            {
+                case 0:
+                    circles.push_back(circle);
+                    grid.push_back(circle.position, circle.radius);
+                    name = "push_back";
+                    break;
+                case 1:
+                    index = random() % (circles.size() + 1);
+                    circles.insert(circles.begin() + index, circle);
+                    grid.insert(index, circle.position, circle.radius);
+                    name = "insert";
+                    break;
+                case 2:
+                    circles.erase(circles.begin() + index);
+                    grid.erase(index);
+                    name = "erase";
+                    break;
+                default:
+                    // Small moves keep most of the cells, jumps replace them
+                    if (random() % 2 == 0 && std::isfinite(circles[index].radius))
+                    {
+                        circle.position = circles[index].position + (circle.position - circles[index].position) * 0.05f;
+                    }
+
+                    circles[index] = circle;
+                    grid.update(index, circle.position, circle.radius);
+                    name = "update";
+                    break;
+            }
+
+            if (grid.size() != circles.size())
+            {
+                fmt::println("seed {}: grid holds {} circles instead of {} after edit {} ({})", seed, grid.size(), circles.size(), edit, name);
+                failures++;
+                break;
+            }
+
+            for (auto query = 0; query < TEST_QUERIES_PER_EDIT; query++)
+            {
+                auto point = generate_point(circles, random);
+                auto expected = find_first_linear(circles, point);
+                auto found = grid.find_first(point);
+
+                if (found != expected)
+                {
+                    fmt::println("seed {}: picked {} instead of {} at ({}, {}) after edit {} ({})", seed, found, expected, point.x, point.y, edit, name);
+                    failures++;
+                    break;
+                }
+            }
+        }
+    }
+
+    return failures > 0 ? 1 : 0;
+}
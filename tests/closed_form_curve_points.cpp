@@ -0,0 +1,175 @@
+#include <chain_generator.hpp>
+#include <cmath>
+#include <fmt/core.h>
+#include <skinning.hpp>
+#include <test_chains.hpp>
+
+#define TEST_SEEDS 4
+#define TEST_CHAIN_CIRCLES 5000
+// Relative to the circle radius. The search steps from the touching circle's centre and loses
+// more precision than the closed form, which steps from the circle's own centre.
+#define TEST_POINT_TOLERANCE 1e-2f
+
+using CurvePoints = std::tuple<glm::vec2, glm::vec2>;
+
+static bool same_bits(const CurvePoints &a, const CurvePoints &b)
+{
+    return same_bits(std::get<0>(a), std::get<0>(b)) && same_bits(std::get<1>(a), std::get<1>(b));
+}
+
+static bool is_near(glm::vec2 a, glm::vec2 b, float radius)
+{
+    return glm::distance(a, b) <= TEST_POINT_TOLERANCE * radius;
+}
+
+// Whether the closed form has to leave a solved touching circle to the search, written out
+// from its definition
+static bool needs_search(const SkinCircle &circle, const TouchingCircle &touching_circle, float s)
+{
+    auto finite = std::isfinite(touching_circle.radius) && std::isfinite(touching_circle.position.x) && std::isfinite(touching_circle.position.y);
+
+    return !finite || glm::abs(touching_circle.radius + s * circle.radius) < CLOSED_FORM_MIN_DISTANCE;
+}
+
+struct ChainCounts
+{
+    size_t fallbacks = 0;
+    size_t compared = 0;
+    size_t failures = 0;
+};
+
+template <typename Precision>
+static ChainCounts check_chain(std::span<const SkinCircle> chain, ChainKind kind, unsigned int seed)
+{
+    ChainCounts counts;
+
+    for (auto i = 1; i + 1 < (int)chain.size(); i++)
+    {
+        auto &circle = chain[i];
+        auto outer = find_touching_circle<Precision>(chain[i - 1], circle, chain[i + 1], 1, 1, 1);
+        auto inner = find_touching_circle<Precision>(chain[i - 1], circle, chain[i + 1], -1, -1, -1);
+        auto closed_form = select_closed_form_curve_points(chain, i, outer, inner);
+
+        auto fail = [&](const char *reason)
+        {
+            if (counts.failures++ == 0)
+            {
+                fmt::println("{} chain, seed {}, circle {}: {}", get_chain_kind_name(kind), seed, i, reason);
+            }
+        };
+
+        auto expect_search = outer && inner && (needs_search(circle, *outer, 1.0f) || needs_search(circle, *inner, -1.0f));
+
+        if (!closed_form)
+        {
+            counts.fallbacks++;
+
+            if (!expect_search)
+            {
+                fail("fell back to the search without a degenerate touching circle");
+            }
+
+            continue;
+        }
+
+        if (expect_search)
+        {
+            fail("used the closed form for a degenerate touching circle");
+            continue;
+        }
+
+        auto search = search_curve_points_for_circle<Precision>(chain, i);
+
+        // A missing solution makes both return the tangent points
+        if (!outer || !inner)
+        {
+            if (!same_bits(*closed_form, search))
+            {
+                fail("tangent point fallback differs from the search");
+            }
+
+            continue;
+        }
+
+        for (auto point : { std::get<0>(*closed_form), std::get<1>(*closed_form) })
+        {
+            if (glm::abs(glm::distance(point, circle.position) - circle.radius) > TEST_POINT_TOLERANCE * circle.radius)
+            {
+                fail("closed form point is not on the circle");
+            }
+        }
+
+        // Elsewhere the search kept a mixed-sign circle because of its 0.1 tolerance, gave up on
+        // both and used the tangent points, or stepped a negative radius off the circle, all of
+        // which the closed form does not do on purpose. Where it kept exactly the outer and
+        // inner circle they have to agree.
+        std::optional<TouchingCircle> pair[] = { outer, inner };
+        auto tangent_points = get_tangent_points(circle.position, circle.radius, chain[i + 1].position, chain[i + 1].radius);
+        auto comparable = outer->radius > 0.0f && inner->radius > 0.0f
+            && same_bits(search, select_curve_points(chain, i, pair))
+            && !same_bits(search, std::make_tuple(tangent_points.c1_p1, tangent_points.c1_p2));
+
+        if (comparable)
+        {
+            counts.compared++;
+
+            if (!is_near(std::get<0>(*closed_form), std::get<0>(search), circle.radius) || !is_near(std::get<1>(*closed_form), std::get<1>(search), circle.radius))
+            {
+                fail("closed form points differ from the search");
+            }
+        }
+    }
+
+    return counts;
+}
+
+// The closed form pick must agree with the search wherever the search kept the same two
+// touching circles, and the context must count exactly the circles it left to the search
+template <typename Precision>
+static size_t check_chains()
+{
+    size_t failures = 0;
+    size_t fallbacks = 0;
+    size_t compared = 0;
+
+    for (auto kind : { ChainKind::Random, ChainKind::NearlyCollinear, ChainKind::Overlapping, ChainKind::RadiusExtremes })
+    {
+        for (unsigned int seed = 1; seed <= TEST_SEEDS; seed++)
+        {
+            auto chain = generate_chain(kind, TEST_CHAIN_CIRCLES, seed);
+            auto counts = check_chain<Precision>(chain, kind, seed);
+
+            SkinStorage skin;
+            SkinningContext context;
+
+            skin.resize(chain.size());
+            context.calculate_skin<Precision>(chain, skin.get_buffers());
+
+            if (context.get_closed_form_fallbacks() != counts.fallbacks)
+            {
+                fmt::println("{} chain, seed {}: {} fallbacks counted, {} circles fell back", get_chain_kind_name(kind), seed, context.get_closed_form_fallbacks(), counts.fallbacks);
+                failures++;
+            }
+
+            failures += counts.failures;
+            fallbacks += counts.fallbacks;
+            compared += counts.compared;
+        }
+    }
+
+    // Both paths have to be taken for the checks to mean anything
+    if (fallbacks == 0 || compared == 0)
+    {
+        fmt::println("{} fallbacks and {} circles compared with the search", fallbacks, compared);
+        failures++;
+    }
+
+    return failures;
+}
+
+int main()
+{
+    auto failures = check_chains<FloatPrecision>() + check_chains<MixedPrecision>();
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,104 @@
+#include <circle.hpp>
+#include <fmt/core.h>
+#include <random>
+#include <skinning.hpp>
+#include <test_chains.hpp>
+
+#define TEST_SEEDS 8
+#define TEST_EDITS 200
+// Chains grow at most this many circles past their starting size
+#define TEST_MAX_GROWTH 8
+
+// A circle near the one at index, or near the chain when it is empty
+static SkinCircle generate_circle(const std::vector<SkinCircle> &chain, size_t index, std::mt19937 &random)
+{
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    auto radius = MIN_CIRCLE_SIZE + unit(random) * (MAX_CIRCLE_SIZE - MIN_CIRCLE_SIZE) * 0.5f;
+    auto position = chain.empty() ? glm::vec2(0.0f) : chain[glm::min(index, chain.size() - 1)].position;
+    auto offset = glm::vec2(unit(random) - 0.5f, unit(random) - 0.5f) * 2.0f * radius;
+
+    return SkinCircle{position + offset, radius};
+}
+
+// Applies one random edit and marks it the way the editor does, returns its name
+static const char *apply_edit(std::vector<SkinCircle> &chain, size_t max_size, SkinningContext &context, std::mt19937 &random)
+{
+    auto kind = random() % 4;
+    auto index = random() % chain.size();
+
+    if (kind == 0 && chain.size() < max_size)
+    {
+        index = random() % (chain.size() + 1);
+        chain.insert(chain.begin() + index, generate_circle(chain, index, random));
+        context.mark_dirty(index, chain.size() - 1);
+        return "insert";
+    }
+
+    if (kind == 1 && chain.size() > 2)
+    {
+        chain.erase(chain.begin() + index);
+        context.mark_dirty(index, chain.size() - 1);
+        return "erase";
+    }
+
+    chain[index] = generate_circle(chain, index, random);
+    context.mark_dirty(index);
+
+    // Two edits far apart before one update, the window spans both
+    if (kind == 2)
+    {
+        auto other = random() % chain.size();
+
+        chain[other] = generate_circle(chain, other, random);
+        context.mark_dirty(other);
+        return "set two";
+    }
+
+    return "set";
+}
+
+// update_skin only recomputes the window around the edited circles, the rest of the skin kept
+// from earlier passes must still be exactly what a full pass gives
+int main()
+{
+    size_t failures = 0;
+
+    for (size_t size : { 2, 3, 4, 5, 50 })
+    {
+        for (unsigned int seed = 1; seed <= TEST_SEEDS; seed++)
+        {
+            auto chain = generate_chain(ChainKind::Random, size, seed);
+            std::mt19937 random(seed);
+
+            SkinStorage skin;
+            SkinStorage expected_skin;
+            SkinningContext context;
+
+            skin.resize(chain.size());
+            context.calculate_skin(chain, skin.get_buffers());
+
+            for (auto edit = 0; edit < TEST_EDITS; edit++)
+            {
+                auto name = apply_edit(chain, size + TEST_MAX_GROWTH, context, random);
+
+                skin.resize(chain.size());
+                context.update_skin(chain, skin.get_buffers());
+
+                SkinningContext expected;
+
+                expected_skin.resize(chain.size());
+                expected.calculate_skin(chain, expected_skin.get_buffers());
+
+                if (auto differences = count_skin_differences(expected_skin, skin))
+                {
+                    fmt::println("{} circles, seed {}: {} points or curves differ after edit {} ({})", size, seed, differences, edit, name);
+                    failures++;
+                    break;
+                }
+            }
+        }
+    }
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,62 @@
+#include <fmt/core.h>
+#include <skinning.hpp>
+#include <test_chains.hpp>
+#include <thread_pool.hpp>
+
+#define TEST_CHAIN_CIRCLES 20000
+// Small enough to split the chain into many chunks
+#define TEST_PARALLEL_GRAIN 256
+
+// Chunks skinned on the pool must give exactly the output of one serial pass
+int main()
+{
+    auto chain = generate_chain(ChainKind::Random, TEST_CHAIN_CIRCLES, 7);
+
+    ThreadPool thread_pool;
+    SkinStorage serial_skin;
+    SkinStorage parallel_skin;
+    SkinningContext serial;
+    SkinningContext parallel;
+
+    parallel.thread_pool = &thread_pool;
+    parallel.parallel_grain = TEST_PARALLEL_GRAIN;
+
+    serial_skin.resize(chain.size());
+    parallel_skin.resize(chain.size());
+
+    serial.calculate_skin(chain, serial_skin.get_buffers());
+    parallel.calculate_skin(chain, parallel_skin.get_buffers());
+
+    size_t failures = 0;
+
+    if (auto differences = count_skin_differences(serial_skin, parallel_skin))
+    {
+        fmt::println("calculate_skin: {} points or curves differ", differences);
+        failures++;
+    }
+
+    // A window long enough to be split as well
+    for (size_t i = 5000; i < 9000; i++)
+    {
+        chain[i].position += glm::vec2(3.0f, -2.0f);
+    }
+
+    serial.mark_dirty(5000, 8999);
+    parallel.mark_dirty(5000, 8999);
+    serial.update_skin(chain, serial_skin.get_buffers());
+    parallel.update_skin(chain, parallel_skin.get_buffers());
+
+    if (auto differences = count_skin_differences(serial_skin, parallel_skin))
+    {
+        fmt::println("update_skin: {} points or curves differ", differences);
+        failures++;
+    }
+
+    if (serial.get_closed_form_fallbacks() != parallel.get_closed_form_fallbacks())
+    {
+        fmt::println("closed form fallbacks differ: {} serial, {} parallel", serial.get_closed_form_fallbacks(), parallel.get_closed_form_fallbacks());
+        failures++;
+    }
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,92 @@
+#include <filesystem>
+#include <fmt/core.h>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <scene_file.hpp>
+#include <string>
+#include <test_chains.hpp>
+
+#define TEST_CHAIN_CIRCLES 2000
+
+static std::string read_file(const std::filesystem::path &path)
+{
+    std::ifstream file(path, std::ios::binary);
+
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+// Skinning a scene file in chunks, each with its halo circles, must write the same file as
+// skinning it in one piece
+int main()
+{
+    auto directory = std::filesystem::temp_directory_path() / fmt::format("circle_skinning_test_{}", std::random_device()());
+    std::filesystem::create_directories(directory);
+
+    auto scene_path = (directory / "scene.csk").string();
+    auto whole_path = (directory / "whole.cso").string();
+    auto chunked_path = (directory / "chunked.cso").string();
+
+    size_t failures = 0;
+    auto chain = generate_chain(ChainKind::Random, TEST_CHAIN_CIRCLES, 11);
+
+    MappedSceneFile scene;
+
+    if (!write_scene_file(scene_path, chain) || !scene.open(scene_path))
+    {
+        fmt::println("Failed to write and open {}", scene_path);
+        failures++;
+    }
+
+    for (auto mixed_precision : { false, true })
+    {
+        if (failures > 0 || !skin_scene_file(scene, whole_path, TEST_CHAIN_CIRCLES, mixed_precision))
+        {
+            failures++;
+            break;
+        }
+
+        auto whole = read_file(whole_path);
+
+        // Down to single circles, and sizes that leave a short last chunk
+        for (size_t chunk_circles : { 1, 2, 3, 7, 256, 999, 1999 })
+        {
+            if (!skin_scene_file(scene, chunked_path, chunk_circles, mixed_precision) || read_file(chunked_path) != whole)
+            {
+                fmt::println("Chunks of {} circles{} differ from the whole scene", chunk_circles, mixed_precision ? " in mixed precision" : "");
+                failures++;
+            }
+        }
+    }
+
+    scene.close();
+
+    // Files with circles the skinning can not handle are rejected when opened
+    for (auto radius : { 0.0f, -1.0f, NAN, INFINITY })
+    {
+        auto broken = chain;
+        broken[TEST_CHAIN_CIRCLES / 2].radius = radius;
+
+        if (!write_scene_file(scene_path, broken) || scene.open(scene_path))
+        {
+            fmt::println("A scene with the radius {} was not rejected", radius);
+            failures++;
+        }
+    }
+
+    auto broken = chain;
+    broken[0].position.x = NAN;
+
+    if (!write_scene_file(scene_path, broken) || scene.open(scene_path))
+    {
+        fmt::println("A scene with a NaN position was not rejected");
+        failures++;
+    }
+
+    scene.close();
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+
+    return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <atomic>
+#include <chain_scene.hpp>
+#include <chrono>
+#include <fmt/core.h>
+#include <random>
+#include <skin_worker.hpp>
+#include <test_chains.hpp>
+#include <thread>
+
+#define TEST_CHAINS 6
+#define TEST_CHAIN_CIRCLES 40
+#define TEST_ROUNDS 100
+// Every pass moving a circle adds at least one range, so this many overflow the pending ranges
+#define TEST_OVERFLOW_PASSES (SKIN_WORKER_MAX_PENDING_RANGES + 1)
+#define TEST_TIMEOUT std::chrono::seconds(30)
+
+std::atomic<size_t> published_results = 0;
+
+void count_result()
+{
+    published_results.fetch_add(1, std::memory_order_release);
+}
+
+struct WorkerTest
+{
+    SkinWorker worker;
+    std::vector<SkinCircle> circles;
+    std::vector<size_t> chain_starts = { 0 };
+    std::mt19937 random{ 5 };
+    // Skin as the render thread sees it after applying every acquired result
+    SkinStorage applied;
+    size_t expected_results = 0;
+    uint32_t generation = 0;
+    size_t failures = 0;
+
+    void add_chain(size_t count, unsigned int seed)
+    {
+        auto chain = generate_chain(ChainKind::Random, count, seed);
+        auto offset = glm::vec2(0.0f, 1000.0f * chain_starts.size());
+
+        for (auto &circle : chain)
+        {
+            circles.push_back(SkinCircle{circle.position + offset, circle.radius});
+        }
+
+        chain_starts.push_back(circles.size());
+    }
+
+    void remove_last_chain()
+    {
+        chain_starts.pop_back();
+        circles.resize(chain_starts.back());
+    }
+
+    void move_random_circle()
+    {
+        std::uniform_real_distribution<float> offset(-5.0f, 5.0f);
+        auto &circle = circles[random() % circles.size()];
+
+        circle.position += glm::vec2(offset(random), offset(random));
+    }
+
+    // Submits the circles and waits until the worker published the result for them
+    bool submit()
+    {
+        generation = worker.submit(circles, chain_starts);
+        expected_results++;
+
+        auto start = std::chrono::steady_clock::now();
+
+        while (published_results.load(std::memory_order_acquire) < expected_results)
+        {
+            if (std::chrono::steady_clock::now() - start > TEST_TIMEOUT)
+            {
+                fmt::println("no result for generation {}", generation);
+                failures++;
+                return false;
+            }
+
+            std::this_thread::yield();
+        }
+
+        return true;
+    }
+
+    // As apply_skin_result in main, but every range is checked before it is copied
+    bool apply(const SkinResult &result)
+    {
+        if (result.full)
+        {
+            applied.left_points = result.skin.left_points;
+            applied.right_points = result.skin.right_points;
+            applied.curves = result.skin.curves;
+            return true;
+        }
+
+        size_t offset = 0;
+
+        for (auto &range : result.point_ranges)
+        {
+            auto count = range.last - range.first + 1;
+
+            if (range.first > range.last || range.last >= applied.left_points.size() || offset + count > result.skin.left_points.size())
+            {
+                fmt::println("point range {}..{} out of bounds", range.first, range.last);
+                return false;
+            }
+
+            std::copy_n(result.skin.left_points.begin() + offset, count, applied.left_points.begin() + range.first);
+            std::copy_n(result.skin.right_points.begin() + offset, count, applied.right_points.begin() + range.first);
+            offset += count;
+        }
+
+        offset = 0;
+
+        for (auto &range : result.curve_ranges)
+        {
+            auto count = range.last - range.first + 1;
+
+            if (range.first > range.last || range.last >= applied.curves.size() || offset + count > result.skin.curves.size())
+            {
+                fmt::println("curve range {}..{} out of bounds", range.first, range.last);
+                return false;
+            }
+
+            std::copy_n(result.skin.curves.begin() + offset, count, applied.curves.begin() + range.first);
+            offset += count;
+        }
+
+        return true;
+    }
+
+    // Acquires the newest result, applies it and compares the applied skin with a fresh one
+    void check(const char *step, bool expect_full)
+    {
+        auto result = worker.acquire_result();
+
+        if (result == nullptr || result->generation != generation)
+        {
+            fmt::println("{}: no result for generation {}", step, generation);
+            failures++;
+            return;
+        }
+
+        if (result->full != expect_full)
+        {
+            fmt::println("{}: expected a {} result", step, expect_full ? "full" : "partial");
+            failures++;
+        }
+
+        if (!apply(*result))
+        {
+            fmt::println("{}: result could not be applied", step);
+            failures++;
+            return;
+        }
+
+        ChainScene scene;
+
+        scene.assign(circles, chain_starts);
+        scene.update_skins();
+
+        if (auto differences = count_skin_differences(scene.get_skin(), applied))
+        {
+            fmt::println("{}: {} points or curves differ", step, differences);
+            failures++;
+        }
+    }
+};
+
+// The render thread applies every result it acquires on top of the ones before, whatever
+// passes it skipped, and must end up with the skin of the latest snapshot
+int main()
+{
+    WorkerTest test;
+
+    // A single circle and an empty chain are skinned differently from the rest
+    for (unsigned int chain = 0; chain < TEST_CHAINS; chain++)
+    {
+        test.add_chain(TEST_CHAIN_CIRCLES + chain, chain + 1);
+    }
+
+    test.add_chain(1, 100);
+    test.add_chain(0, 101);
+
+    test.worker.result_callback = count_result;
+    test.worker.start();
+
+    if (test.submit())
+    {
+        test.check("first result", true);
+    }
+
+    for (auto round = 0; round < TEST_ROUNDS && test.failures == 0; round++)
+    {
+        // Passes the render thread never picked up still have to reach it
+        auto passes = 1 + test.random() % 4;
+
+        for (size_t pass = 0; pass < passes; pass++)
+        {
+            test.move_random_circle();
+            test.submit();
+        }
+
+        test.check("edits", false);
+    }
+
+    test.add_chain(TEST_CHAIN_CIRCLES, 200);
+
+    if (test.submit())
+    {
+        test.check("chain added", true);
+    }
+
+    test.move_random_circle();
+
+    if (test.submit())
+    {
+        test.check("edit after adding a chain", false);
+    }
+
+    test.remove_last_chain();
+
+    if (test.submit())
+    {
+        test.check("chain removed", true);
+    }
+
+    for (auto pass = 0; pass < TEST_OVERFLOW_PASSES; pass++)
+    {
+        test.move_random_circle();
+        test.submit();
+    }
+
+    test.check("pending ranges overflow", true);
+    test.move_random_circle();
+
+    if (test.submit())
+    {
+        test.check("edit after overflow", false);
+    }
+
+    test.worker.stop();
+
+    return test.failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,55 @@
+#include <allocation_counter.hpp>
+#include <fmt/core.h>
+#include <skinning.hpp>
+#include <test_chains.hpp>
+
+#define TEST_CHAIN_CIRCLES 1000
+#define TEST_PASSES 10
+
+// Once a context and its storage have seen a chain, skinning it again must not allocate
+int main()
+{
+    auto chain = generate_chain(ChainKind::Random, TEST_CHAIN_CIRCLES, 1);
+
+    SkinStorage skin;
+    SkinningContext context;
+
+    skin.resize(chain.size());
+    context.calculate_skin(chain, skin.get_buffers());
+    context.update_skin(chain, skin.get_buffers());
+
+    auto failed = false;
+    auto allocations = get_allocation_count();
+
+    for (auto pass = 0; pass < TEST_PASSES; pass++)
+    {
+        skin.resize(chain.size());
+        context.calculate_skin(chain, skin.get_buffers());
+    }
+
+    if (get_allocation_count() != allocations)
+    {
+        fmt::println("calculate_skin: {} allocations in {} passes", get_allocation_count() - allocations, TEST_PASSES);
+        failed = true;
+    }
+
+    allocations = get_allocation_count();
+
+    for (auto pass = 0; pass < TEST_PASSES; pass++)
+    {
+        // A drag moves one circle per update
+        auto index = (pass * 97) % chain.size();
+
+        chain[index].position += glm::vec2(1.0f, 0.5f);
+        context.mark_dirty(index);
+        context.update_skin(chain, skin.get_buffers());
+    }
+
+    if (get_allocation_count() != allocations)
+    {
+        fmt::println("update_skin: {} allocations in {} passes", get_allocation_count() - allocations, TEST_PASSES);
+        failed = true;
+    }
+
+    return failed ? 1 : 0;
+}
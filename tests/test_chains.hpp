@@ -0,0 +1,41 @@
+#pragma once
+
+#include <chain_generator.hpp>
+#include <cstring>
+#include <skinning.hpp>
+
+inline bool same_bits(glm::vec2 a, glm::vec2 b)
+{
+    return std::memcmp(&a, &b, sizeof(glm::vec2)) == 0;
+}
+
+inline bool same_bits(const HermiteCurve &a, const HermiteCurve &b)
+{
+    return same_bits(a.get_p0(), b.get_p0()) && same_bits(a.get_p1(), b.get_p1())
+        && same_bits(a.get_v0(), b.get_v0()) && same_bits(a.get_v1(), b.get_v1())
+        && a.get_color() == b.get_color();
+}
+
+// Points and curves that are not bit for bit the same, a size mismatch counts as all of them
+inline size_t count_skin_differences(const SkinStorage &expected, const SkinStorage &actual)
+{
+    if (expected.left_points.size() != actual.left_points.size() || expected.curves.size() != actual.curves.size())
+    {
+        return glm::max(expected.left_points.size(), actual.left_points.size()) + glm::max(expected.curves.size(), actual.curves.size());
+    }
+
+    size_t differences = 0;
+
+    for (size_t i = 0; i < expected.left_points.size(); i++)
+    {
+        differences += !same_bits(expected.left_points[i], actual.left_points[i]);
+        differences += !same_bits(expected.right_points[i], actual.right_points[i]);
+    }
+
+    for (size_t i = 0; i < expected.curves.size(); i++)
+    {
+        differences += !same_bits(expected.curves[i], actual.curves[i]);
+    }
+
+    return differences;
+}
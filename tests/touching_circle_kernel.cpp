@@ -0,0 +1,83 @@
+#include <cstring>
+#include <fmt/core.h>
+#include <skinning.hpp>
+#include <test_chains.hpp>
+#include <touching_circle_kernel.hpp>
+#include <vector>
+
+#define TEST_SEEDS 8
+// Not a multiple of any vector width, so the scalar tails are covered as well
+#define TEST_CHAIN_CIRCLES 1003
+
+static bool same_bits(float a, float b)
+{
+    return std::memcmp(&a, &b, sizeof(float)) == 0;
+}
+
+// Every ISA the build and the CPU support has to give results bit-identical to
+// find_touching_circle with the all-positive and the all-negative signs
+int main()
+{
+    size_t failures = 0;
+    auto best_isa = get_best_kernel_isa();
+
+    for (unsigned int seed = 1; seed <= TEST_SEEDS; seed++)
+    {
+        auto chain = generate_chain(ChainKind::Random, TEST_CHAIN_CIRCLES, seed);
+
+        std::vector<float> x, y, radius;
+
+        for (auto &circle : chain)
+        {
+            x.push_back(circle.position.x);
+            y.push_back(circle.position.y);
+            radius.push_back(circle.radius);
+        }
+
+        auto count = chain.size() - 2;
+
+        for (auto isa : { KernelIsa::Scalar, KernelIsa::Sse2, KernelIsa::Avx2 })
+        {
+            if ((int)isa > (int)best_isa)
+            {
+                continue;
+            }
+
+            std::vector<float> out_x(TOUCHING_CIRCLE_PAIR * count);
+            std::vector<float> out_y(TOUCHING_CIRCLE_PAIR * count);
+            std::vector<float> out_radius(TOUCHING_CIRCLE_PAIR * count);
+            std::vector<uint8_t> out_valid(TOUCHING_CIRCLE_PAIR * count);
+
+            find_touching_circles(isa, x, y, radius, 1, count, TouchingCircleArrays{out_x, out_y, out_radius, out_valid});
+
+            for (size_t i = 0; i < count; i++)
+            {
+                for (auto pair = 0; pair < TOUCHING_CIRCLE_PAIR; pair++)
+                {
+                    auto sign = pair == 0 ? 1 : -1;
+                    auto expected = find_touching_circle(chain[i], chain[i + 1], chain[i + 2], sign, sign, sign);
+                    auto k = pair * count + i;
+
+                    auto matches = expected.has_value() == (out_valid[k] != 0);
+
+                    if (matches && expected)
+                    {
+                        matches = same_bits(expected->position.x, out_x[k]) && same_bits(expected->position.y, out_y[k]) && same_bits(expected->radius, out_radius[k]);
+                    }
+
+                    if (!matches && failures++ < 10)
+                    {
+                        fmt::println("{}: seed {}, circle {}, signs {}: differs from find_touching_circle", get_kernel_isa_name(isa), seed, i + 1, sign);
+                    }
+                }
+            }
+        }
+    }
+
+    if (failures > 0)
+    {
+        fmt::println("{} touching circles differ", failures);
+    }
+
+    return failures > 0 ? 1 : 0;
+}